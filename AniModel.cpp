@@ -376,8 +376,13 @@ void AniModel::Draw(Shader& shader,float elapsedTime) {
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, diffuseTexture.id);
 	//glUniform1i(, 0);
-	glUniform1i(glGetUniformLocation(shader.Program, "diff_texture"), 0);
-	glUniformMatrix4fv(glGetUniformLocation(shader.Program,"bone_transforms"), boneCount, GL_FALSE, &(currentPose[0])[0][0]);
+	if (uniformProgram != shader.Program) {
+		uniformProgram = shader.Program;
+		diffTextureLocation = shader.uniform("diff_texture");
+		boneTransformsLocation = shader.uniform("bone_transforms");
+	}
+	shader.setInt(diffTextureLocation, 0);
+	shader.setMat4(boneTransformsLocation, &(currentPose[0])[0][0], boneCount);
 
 	glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
 
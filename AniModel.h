@@ -116,4 +116,10 @@ private:
     glm::mat4 globalInverseTransform;
 
     vector<Ani::Texture> textures_loaded;
+
+    // where Draw() puts the texture and the pose, in the program it was
+    // last given, so they are looked up once and not every frame
+    uint uniformProgram = 0;
+    int diffTextureLocation = -1;
+    int boneTransformsLocation = -1;
 };
\ No newline at end of file
@@ -18,17 +18,11 @@ public:
 	ParticleSystem() {
 		this->particles = {};
 	}
-	void bindShaderProjectionMatrix(Shader& shader) {
-		glm::mat4 project_matrix;
-		glGetFloatv(GL_PROJECTION_MATRIX, &project_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(shader.Program, "projection"), 1, GL_FALSE, &project_matrix[0][0]);
-	}
 
 
 
 	typedef glm::vec3 vec3;
-	void updateModelViewMatrix(vec3 pos, float r, float s, glm::mat4& viewMatrix, glm::mat4& modelMatrix) {
+	void updateModelViewMatrix(vec3 pos, float r, float s, const glm::mat4& viewMatrix, glm::mat4& modelMatrix) {
 		//set it like the billboard
 		glm::mat4 model_matrix = glm::mat4();
 		model_matrix = glm::translate(model_matrix, pos);
@@ -288,22 +282,22 @@ public:
 		}
 	}
 
-	void renderParticles(Shader& shader) {
+	// viewMatrix is the camera's (the shader gets it from the Frame block);
+	// it is only needed here to turn the particles to face it
+	void renderParticles(Shader& shader, const glm::mat4& viewMatrix) {
 
-		glm::mat4 viewMatrix;
-		glGetFloatv(GL_MODELVIEW_MATRIX, &viewMatrix[0][0]);
 		glm::mat4 model_matrix;
+		// givenColor is looked up once per program, not once per particle
+		if (this->colorProgram != shader.Program) {
+			this->colorProgram = shader.Program;
+			this->givenColor = shader.uniform("givenColor");
+		}
 		for (auto p : this->particles)
 		{
 			shader.Use();
-			this->bindShaderProjectionMatrix(shader);
 			this->updateModelViewMatrix(p.position, p.rotate, p.scale, viewMatrix, model_matrix);
-			glUniformMatrix4fv(
-				glGetUniformLocation(shader.Program, "model"), 1, GL_FALSE, &model_matrix[0][0]);
-			glUniformMatrix4fv(
-				glGetUniformLocation(shader.Program, "view"), 1, GL_FALSE, &viewMatrix[0][0]);
-			glUniform3fv(
-				glGetUniformLocation(shader.Program, "givenColor"), 1, &p.col[0]);
+			shader.setMat4(Shader::MODEL, &model_matrix[0][0]);
+			shader.setVec3(this->givenColor, p.col[0], p.col[1], p.col[2]);
 			p.draw(shader);
 		}
 	}
@@ -313,6 +307,6 @@ public:
 	}
 
 private:
-
-
+	GLuint colorProgram = 0;	// the program givenColor was looked up in
+	GLint givenColor = -1;
 };
\ No newline at end of file
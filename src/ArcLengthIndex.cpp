@@ -0,0 +1,330 @@
+/************************************************************************
+     File:        ArcLengthIndex.cpp
+
+     Comment:     Cumulative arc-length table for the track
+
+						See ArcLengthIndex.H
+
+     Platform:    Visio Studio.Net 2003/2005
+
+*************************************************************************/
+
+#include <math.h>
+#include <algorithm>
+
+#include "ArcLengthIndex.H"
+
+//****************************************************************************
+//
+// * Constructor
+//============================================================================
+ArcLengthIndex::
+ArcLengthIndex()
+//============================================================================
+{
+	prefix.push_back(0);
+}
+
+//****************************************************************************
+//
+// * Start a new table
+//============================================================================
+void ArcLengthIndex::
+clear()
+//============================================================================
+{
+	prefix.clear();
+	prefix.push_back(0);
+	sampleSegment.clear();
+	sampleT0.clear();
+	sampleT1.clear();
+	sampleFrame.clear();
+	segmentFirst.clear();
+}
+
+//****************************************************************************
+//
+// * Add the next piece of the track
+//============================================================================
+void ArcLengthIndex::
+addSample(double length, int segment, float t0, float t1, const TrackFrame& frame)
+//============================================================================
+{
+	if (sampleSegment.empty() || sampleSegment.back() != segment)
+		segmentFirst.push_back(sampleSegment.size());
+
+	prefix.push_back(prefix.back() + length);
+	sampleSegment.push_back(segment);
+	sampleT0.push_back(t0);
+	sampleT1.push_back(t1);
+	sampleFrame.push_back(frame);
+}
+
+//****************************************************************************
+//
+// * Patch one segment in place - cheaper than building the whole table
+//   again, since the rest of the track only moves by a constant. If the
+//   number of pieces changed, the tables after the segment slide over
+//============================================================================
+void ArcLengthIndex::
+replaceSegment(int segment, const vector<double>& lengths, const vector<float>& ts,
+			   const vector<TrackFrame>& frames)
+//============================================================================
+{
+	if (segment < 0 || (size_t)segment >= segmentFirst.size() || lengths.empty())
+		return;
+
+	size_t first = segmentFirst[segment];
+	size_t last = ((size_t)segment + 1 < segmentFirst.size()) ? segmentFirst[segment + 1] : sampleCount();
+	size_t oldCount = last - first;
+	size_t newCount = lengths.size();
+	double oldEnd = prefix[last];
+
+	if (newCount != oldCount) {
+		// prefix[first + 1 .. last] are the ends of the segment's pieces
+		if (newCount > oldCount) {
+			size_t grow = newCount - oldCount;
+			prefix.insert(prefix.begin() + last + 1, grow, 0.0);
+			sampleSegment.insert(sampleSegment.begin() + last, grow, segment);
+			sampleT0.insert(sampleT0.begin() + last, grow, 0.0f);
+			sampleT1.insert(sampleT1.begin() + last, grow, 0.0f);
+			sampleFrame.insert(sampleFrame.begin() + last, grow, TrackFrame());
+		}
+		else {
+			prefix.erase(prefix.begin() + first + newCount + 1, prefix.begin() + last + 1);
+			sampleSegment.erase(sampleSegment.begin() + first + newCount, sampleSegment.begin() + last);
+			sampleT0.erase(sampleT0.begin() + first + newCount, sampleT0.begin() + last);
+			sampleT1.erase(sampleT1.begin() + first + newCount, sampleT1.begin() + last);
+			sampleFrame.erase(sampleFrame.begin() + first + newCount, sampleFrame.begin() + last);
+		}
+		for (size_t k = segment + 1; k < segmentFirst.size(); ++k)
+			segmentFirst[k] = segmentFirst[k] + newCount - oldCount;
+		last = first + newCount;
+	}
+
+	for (size_t j = 0; j < newCount; ++j) {
+		prefix[first + j + 1] = prefix[first + j] + lengths[j];
+		sampleT0[first + j] = ts[j];
+		sampleT1[first + j] = ts[j + 1];
+		sampleFrame[first + j] = frames[j];
+	}
+
+	double delta = prefix[last] - oldEnd;
+	if (delta != 0)
+		for (size_t k = last + 1; k < prefix.size(); ++k)
+			prefix[k] += delta;
+}
+
+//****************************************************************************
+//
+// * The tables are empty vectors for an empty track, so hand out null
+//============================================================================
+void ArcLengthIndex::
+getTables(const double*& outPrefix, const int*& segments, const float*& t0, const float*& t1,
+		  const TrackFrame*& frames) const
+//============================================================================
+{
+	bool empty = sampleSegment.empty();
+	outPrefix = &prefix[0];
+	segments = empty ? 0 : &sampleSegment[0];
+	t0 = empty ? 0 : &sampleT0[0];
+	t1 = empty ? 0 : &sampleT1[0];
+	frames = empty ? 0 : &sampleFrame[0];
+}
+
+//****************************************************************************
+//
+// * Only segmentFirst has to be worked out again
+//============================================================================
+void ArcLengthIndex::
+setTables(size_t count, const double* newPrefix, const int* segments, const float* t0,
+		  const float* t1, const TrackFrame* frames)
+//============================================================================
+{
+	clear();
+	if (count == 0)
+		return;
+	prefix.assign(newPrefix, newPrefix + count + 1);
+	sampleSegment.assign(segments, segments + count);
+	sampleT0.assign(t0, t0 + count);
+	sampleT1.assign(t1, t1 + count);
+	sampleFrame.assign(frames, frames + count);
+	for (size_t k = 0; k < count; k++)
+		if (k == 0 || sampleSegment[k] != sampleSegment[k - 1])
+			segmentFirst.push_back(k);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+double ArcLengthIndex::
+totalLength() const
+//============================================================================
+{
+	return prefix.back();
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+double ArcLengthIndex::
+segmentStart(int segment) const
+//============================================================================
+{
+	if (segment < 0 || (size_t)segment >= segmentFirst.size())
+		return totalLength();
+	return prefix[segmentFirst[segment]];
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+size_t ArcLengthIndex::
+sampleCount() const
+//============================================================================
+{
+	return prefix.size() - 1;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void ArcLengthIndex::
+getSample(size_t k, int& segment, float& t0, float& t1) const
+//============================================================================
+{
+	segment = sampleSegment[k];
+	t0 = sampleT0[k];
+	t1 = sampleT1[k];
+}
+
+//****************************************************************************
+//
+// * Wrap a distance around the loop
+//============================================================================
+double ArcLengthIndex::
+wrap(double s) const
+//============================================================================
+{
+	double total = totalLength();
+	if (total <= 0)
+		return 0;
+	if (s >= 0 && s < total)
+		return s;
+	s = fmod(s, total);
+	if (s < 0)
+		s += total;
+	return s;
+}
+
+//****************************************************************************
+//
+// * Binary search for the piece that holds the distance s
+//============================================================================
+bool ArcLengthIndex::
+locatePiece(double s, size_t& piece, double& offset) const
+//============================================================================
+{
+	size_t n = sampleCount();
+	if (n == 0 || totalLength() <= 0) {
+		piece = 0;
+		offset = 0;
+		return false;
+	}
+	s = wrap(s);
+
+	// first entry that is strictly past s - the piece we want ends there
+	vector<double>::const_iterator it = std::upper_bound(prefix.begin() + 1, prefix.end(), s);
+	piece = (it == prefix.end()) ? n - 1 : (size_t)(it - prefix.begin()) - 1;
+	offset = s - prefix[piece];
+	return true;
+}
+
+//****************************************************************************
+//
+// * Find the piece, then linearly interpolate inside of it
+//============================================================================
+bool ArcLengthIndex::
+locate(double s, int& segment, float& t) const
+//============================================================================
+{
+	size_t piece;
+	double offset;
+	if (!locatePiece(s, piece, offset)) {
+		segment = 0;
+		t = 0;
+		return false;
+	}
+
+	double len = prefix[piece + 1] - prefix[piece];
+	double x = (len > 0) ? offset / len : 0;
+
+	segment = sampleSegment[piece];
+	t = (float)(sampleT0[piece] + x * (sampleT1[piece] - sampleT0[piece]));
+	return true;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+bool ArcLengthIndex::
+frameAt(double s, TrackFrame& frame) const
+//============================================================================
+{
+	size_t piece;
+	double offset;
+	if (!locatePiece(s, piece, offset))
+		return false;
+	blendFrame(piece, offset, frame);
+	return true;
+}
+
+//****************************************************************************
+//
+// * The distances only go up, so the piece does too
+//============================================================================
+void ArcLengthIndex::
+framesAlong(double s0, double step, size_t count, TrackFrame* frames) const
+//============================================================================
+{
+	size_t piece;
+	double offset;
+	if (count == 0 || !locatePiece(s0, piece, offset))
+		return;
+
+	size_t n = sampleCount();
+	for (size_t k = 0; k < count; k++) {
+		double s = s0 + step * k;
+		while (piece + 1 < n && prefix[piece + 1] <= s)
+			piece++;
+		blendFrame(piece, s - prefix[piece], frames[k]);
+	}
+}
+
+//****************************************************************************
+//
+// * Blend the frames at the two ends of the piece, then make them unit
+//   length and square again
+//============================================================================
+void ArcLengthIndex::
+blendFrame(size_t piece, double offset, TrackFrame& frame) const
+//============================================================================
+{
+	const TrackFrame& a = sampleFrame[piece];
+	const TrackFrame& b = sampleFrame[(piece + 1) % sampleFrame.size()];
+	double len = prefix[piece + 1] - prefix[piece];
+	float x = (len > 0) ? (float)(offset / len) : 0.0f;
+
+	frame.pos = a.pos * (1 - x) + b.pos * x;
+	frame.forward = a.forward * (1 - x) + b.forward * x;
+	frame.forward.normalize();
+	Pnt3f up = a.up * (1 - x) + b.up * x;
+	frame.side = frame.forward * up;
+	frame.side.normalize();
+	frame.up = frame.side * frame.forward;
+}
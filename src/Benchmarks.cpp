@@ -0,0 +1,1187 @@
+/************************************************************************
+     File:        Benchmarks.cpp
+
+     Comment:     Timing routines for the track code
+
+						See Benchmarks.H
+
+     Platform:    Visio Studio.Net 2003/2005
+
+*************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include <thread>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Benchmarks.H"
+#include "ArcLengthIndex.H"
+#include "Track.H"
+#include "Spline.H"
+#include "Frustum.H"
+#include "TrainPhysics.H"
+#include "TrainFleet.H"
+#include "TrackFile.H"
+#include "TrackClearance.H"
+#include "PickIndex.H"
+#include "Utilities/Pnt3f.H"
+
+using std::vector;
+
+typedef std::chrono::high_resolution_clock BenchClock;
+
+//****************************************************************************
+//
+// * milliseconds since a starting time
+//============================================================================
+static double msSince(const BenchClock::time_point& start)
+//============================================================================
+{
+	return std::chrono::duration<double, std::milli>(BenchClock::now() - start).count();
+}
+
+//****************************************************************************
+//
+// * A big wobbly loop - nPoints control points, chopped into
+//   samplesPerSegment straight pieces per segment
+//============================================================================
+static void makeSyntheticTrack(int nPoints, int samplesPerSegment, vector<double>& pieces)
+//============================================================================
+{
+	vector<Pnt3f> pts(nPoints);
+	float radius = 1.5f * nPoints;
+	for (int i = 0; i < nPoints; ++i) {
+		float a = 6.2831853f * i / nPoints;
+		pts[i] = Pnt3f(radius * cos(a), 20.0f + 10.0f * sin(37.0f * a), radius * sin(a) + 5.0f * cos(91.0f * a));
+	}
+
+	// straight pieces between the points, so we don't need a spline here
+	pieces.clear();
+	for (int i = 0; i < nPoints; ++i) {
+		Pnt3f d = pts[(i + 1) % nPoints] - pts[i];
+		double len = d.getLength() / samplesPerSegment;
+		for (int j = 0; j < samplesPerSegment; ++j)
+			pieces.push_back(len);
+	}
+}
+
+//****************************************************************************
+//
+// * This is the lookup the TrainView used to do: walk the piece list from
+//   the front until we pass the distance
+//============================================================================
+static void legacyLocate(const vector<double>& arc_length, int samplesPerSegment,
+						 double pos, int& i, float& t)
+//============================================================================
+{
+	double tmp = 0;
+	int count = 0;
+	while (pos > tmp) {
+		tmp += arc_length[count];
+		count++;
+	}
+	if (count == 0) {
+		i = 0;
+		t = 0;
+		return;
+	}
+	float x = (float)((pos - (tmp - arc_length[count - 1])) / arc_length[count - 1]);
+	i = (count - 1) / samplesPerSegment;
+	t = ((count - 1) % samplesPerSegment + x) / samplesPerSegment;
+}
+
+//****************************************************************************
+//
+// * This is the GMT the TrainView used to have: build the basis matrix for
+//   the type, transpose it, and multiply G * M * T for every point
+//============================================================================
+static Pnt3f legacyGMT(const Pnt3f p0, const Pnt3f p1, const Pnt3f p2, const Pnt3f p3, const int type, const float t)
+//============================================================================
+{
+	glm::mat4x4 M;
+
+	if (type == 0 || type == 1) //default or linear
+	{
+		M = {
+			0,0,0,0,
+			0,0,-1,1,
+			0,0,1,0,
+			0,0,0,0
+		};
+	}
+	else if (type == 2) //cardinal
+	{
+		M = {
+			-1,2,-1,0,
+			3,-5,0,2,
+			-3,4,1,0,
+			1,-1,0,0
+		};
+		M /= 2;
+	}
+	else if (type == 3) //b-spline
+	{
+		M = {
+			-1,3,-3,1,
+			3,-6,0,4,
+			-3,3,3,1,
+			1,0,0,0
+		};
+		M /= 6.0f;
+	}
+	M = glm::transpose(M);
+	glm::mat4x4 G = {
+		p0.x, p0.y, p0.z, 1.0f,
+		p1.x, p1.y, p1.z, 1.0f,
+		p2.x, p2.y, p2.z, 1.0f,
+		p3.x, p3.y, p3.z, 1.0f
+	};
+	glm::vec4 T = { t * t * t,t * t,t,1.0f };
+	glm::vec4 outcome = G * M * T;
+	return Pnt3f(outcome[0], outcome[1], outcome[2]);
+}
+
+//****************************************************************************
+//
+// * Compare the linear scan with the binary search on a nPoints track.
+//   The workload is the one drawTiles has - one lookup every 3.75 units
+//   along the whole track
+//============================================================================
+void benchmarkArcLengthLookup(int nPoints)
+//============================================================================
+{
+	const int samplesPerSegment = 20;
+	const double tileSpacing = 3.75;
+
+	vector<double> pieces;
+	makeSyntheticTrack(nPoints, samplesPerSegment, pieces);
+
+	ArcLengthIndex index;
+	for (size_t k = 0; k < pieces.size(); ++k) {
+		int j = (int)(k % samplesPerSegment);
+		index.addSample(pieces[k], (int)(k / samplesPerSegment),
+						(float)j / samplesPerSegment, (float)(j + 1) / samplesPerSegment);
+	}
+	double total = index.totalLength();
+
+	// the linear scan is so slow that we only time a slice of the tiles
+	// and scale it up - a full sweep on 10k points takes minutes
+	size_t nTiles = (size_t)(total / tileSpacing);
+	size_t stride = (nTiles > 2000) ? nTiles / 2000 : 1;
+
+	int seg;
+	float t;
+	double checksum = 0;
+	size_t scanned = 0;
+	BenchClock::time_point start = BenchClock::now();
+	for (size_t k = 0; k < nTiles; k += stride, ++scanned) {
+		legacyLocate(pieces, samplesPerSegment, k * tileSpacing, seg, t);
+		checksum += seg + t;
+	}
+	double legacyMs = msSince(start) * ((double)nTiles / scanned);
+
+	double maxDiff = 0;
+	for (size_t k = 0; k < nTiles; k += stride) {
+		int seg2;
+		float t2;
+		legacyLocate(pieces, samplesPerSegment, k * tileSpacing, seg, t);
+		index.locate(k * tileSpacing, seg2, t2);
+		double diff = fabs((seg + t) - (seg2 + t2));
+		if (diff > maxDiff) maxDiff = diff;
+	}
+
+	start = BenchClock::now();
+	for (size_t k = 0; k < nTiles; ++k) {
+		index.locate(k * tileSpacing, seg, t);
+		checksum += seg + t;
+	}
+	double indexMs = msSince(start);
+
+	printf("ArcLength lookup: %d points, %u pieces, %u tiles\n",
+		   nPoints, (unsigned)pieces.size(), (unsigned)nTiles);
+	printf("  linear scan  : %10.2f ms per sweep (estimated from %u lookups)\n", legacyMs, (unsigned)scanned);
+	printf("  binary search: %10.2f ms per sweep\n", indexMs);
+	printf("  speedup %.0fx, max |(seg+t)| difference %g (checksum %g)\n",
+		   (indexMs > 0) ? legacyMs / indexMs : 0.0, maxDiff, checksum);
+}
+
+//****************************************************************************
+//
+// * Drag a point around a nPoints track (65535 is the most readPoints takes)
+//   and time what one frame of editing costs both ways. At the end the
+//   patched track (rails, sleepers, pillars and chunks) must agree with one
+//   that was built from scratch
+//============================================================================
+void benchmarkTrackEdit(int nPoints)
+//============================================================================
+{
+	const int splineType = 2;
+	const int nDrags = 50;
+
+	vector<ControlPoint> points(nPoints);
+	float radius = 1.5f * nPoints;
+	for (int i = 0; i < nPoints; ++i) {
+		float a = 6.2831853f * i / nPoints;
+		points[i] = ControlPoint(Pnt3f(radius * cos(a), 20.0f + 10.0f * sin(37.0f * a), radius * sin(a)));
+	}
+
+	TrackMesh full, patched;
+	full.update(points, splineType);
+	patched.update(points, splineType);
+
+	double fullMs = 0, patchMs = 0;
+	for (int k = 0; k < nDrags; ++k) {
+		size_t moved = (size_t)(k * 7919) % nPoints;
+		points[moved].pos.y += 3.0f;
+
+		BenchClock::time_point start = BenchClock::now();
+		full.markDirty();
+		full.update(points, splineType);
+		fullMs += msSince(start);
+
+		start = BenchClock::now();
+		patched.markPointDirty(moved);
+		patched.update(points, splineType);
+		patchMs += msSince(start);
+	}
+
+	double maxDiff = fabs(full.arcLength.totalLength() - patched.arcLength.totalLength());
+	for (size_t k = 0; k < full.railVertices.size(); ++k) {
+		Pnt3f d = full.railVertices[k] - patched.railVertices[k];
+		double diff = d.getLength();
+		if (diff > maxDiff) maxDiff = diff;
+	}
+	for (size_t k = 0; k < full.tileTransforms.size() && k < patched.tileTransforms.size(); ++k)
+		if (fabs(full.tileTransforms[k] - patched.tileTransforms[k]) > maxDiff)
+			maxDiff = fabs(full.tileTransforms[k] - patched.tileTransforms[k]);
+	for (size_t k = 0; k < full.supportInstances.size() && k < patched.supportInstances.size(); ++k)
+		if (fabs(full.supportInstances[k] - patched.supportInstances[k]) > maxDiff)
+			maxDiff = fabs(full.supportInstances[k] - patched.supportInstances[k]);
+	for (size_t c = 0; c < full.chunks.size() && c < patched.chunks.size(); ++c) {
+		Pnt3f d = full.chunks[c].boxMax - patched.chunks[c].boxMax;
+		Pnt3f e = full.chunks[c].boxMin - patched.chunks[c].boxMin;
+		double diff = d.getLength() + e.getLength();
+		if (diff > maxDiff) maxDiff = diff;
+	}
+
+	printf("Track edit: %d points, %d drags, %u sleepers, %u pillars\n", nPoints, nDrags,
+		   (unsigned)(full.tileTransforms.size() / 16), (unsigned)(full.supportInstances.size() / 4));
+	printf("  full resample: %10.3f ms per drag\n", fullMs / nDrags);
+	printf("  local patch  : %10.3f ms per drag\n", patchMs / nDrags);
+	printf("  speedup %.0fx, max difference %g\n",
+		   (patchMs > 0) ? fullMs / patchMs : 0.0, maxDiff);
+}
+
+//****************************************************************************
+//
+// * How far the curve gets from the chord of [t0, t1] (checked at a few
+//   places in between)
+//============================================================================
+static double pieceError(const vector<ControlPoint>& points, int splineType,
+						 int segment, float t0, float t1)
+//============================================================================
+{
+	size_t n = points.size();
+	const Pnt3f& p0 = points[segment % n].pos;
+	const Pnt3f& p1 = points[(segment + 1) % n].pos;
+	const Pnt3f& p2 = points[(segment + 2) % n].pos;
+	const Pnt3f& p3 = points[(segment + 3) % n].pos;
+	Pnt3f a = GMT(p0, p1, p2, p3, splineType, t0);
+	Pnt3f b = GMT(p0, p1, p2, p3, splineType, t1);
+
+	double worst = 0;
+	for (int k = 1; k < 8; ++k) {
+		float x = k / 8.0f;
+		Pnt3f d = GMT(p0, p1, p2, p3, splineType, t0 + x * (t1 - t0)) - (a * (1 - x) + b * x);
+		double err = d.getLength();
+		if (err > worst) worst = err;
+	}
+	return worst;
+}
+
+//****************************************************************************
+//
+// * Chord length of a segment cut into pieces equal pieces
+//============================================================================
+static double uniformLength(const vector<ControlPoint>& points, int splineType,
+							size_t segment, int pieces)
+//============================================================================
+{
+	size_t n = points.size();
+	const Pnt3f& p0 = points[segment % n].pos;
+	const Pnt3f& p1 = points[(segment + 1) % n].pos;
+	const Pnt3f& p2 = points[(segment + 2) % n].pos;
+	const Pnt3f& p3 = points[(segment + 3) % n].pos;
+
+	double len = 0;
+	Pnt3f pre = GMT(p0, p1, p2, p3, splineType, 0);
+	for (int j = 1; j <= pieces; ++j) {
+		Pnt3f q = GMT(p0, p1, p2, p3, splineType, (float)j / pieces);
+		len += (q - pre).getLength();
+		pre = q;
+	}
+	return len;
+}
+
+//****************************************************************************
+//
+// * Compare the old 20 pieces per segment with the adaptive tessellation on
+//   a real track. The length error is against 2000 pieces per segment
+//============================================================================
+void benchmarkTessellation(const char* trackFile)
+//============================================================================
+{
+	const int uniformPieces = 20;
+	const int referencePieces = 2000;
+
+	CTrack track;
+	track.readPoints(trackFile);
+	const vector<ControlPoint>& points = track.points;
+	size_t n = points.size();
+
+	printf("Tessellation: %s, %u points\n", trackFile, (unsigned)n);
+	for (int splineType = 2; splineType <= 3; ++splineType) {
+		double reference = 0, uniform = 0, uniformError = 0;
+		for (size_t i = 0; i < n; ++i) {
+			reference += uniformLength(points, splineType, i, referencePieces);
+			uniform += uniformLength(points, splineType, i, uniformPieces);
+			for (int j = 0; j < uniformPieces; ++j) {
+				double err = pieceError(points, splineType, (int)i,
+										(float)j / uniformPieces, (float)(j + 1) / uniformPieces);
+				if (err > uniformError) uniformError = err;
+			}
+		}
+		size_t uniformVertices = n * (8 + 12 * (uniformPieces - 1));
+
+		TrackMesh mesh;
+		BenchClock::time_point start = BenchClock::now();
+		mesh.update(points, splineType);
+		double buildMs = msSince(start);
+
+		double adaptiveError = 0;
+		for (size_t k = 0; k < mesh.arcLength.sampleCount(); ++k) {
+			int seg;
+			float t0, t1;
+			mesh.arcLength.getSample(k, seg, t0, t1);
+			double err = pieceError(points, splineType, seg, t0, t1);
+			if (err > adaptiveError) adaptiveError = err;
+		}
+
+		printf("  %s\n", (splineType == 2) ? "cardinal" : "b-spline");
+		printf("    uniform : %6u pieces %7u vertices, length error %8.4f, max deviation %.4f\n",
+			   (unsigned)(n * uniformPieces), (unsigned)uniformVertices,
+			   fabs(uniform - reference), uniformError);
+		printf("    adaptive: %6u pieces %7u vertices, length error %8.4f, max deviation %.4f (%.2f ms)\n",
+			   (unsigned)mesh.arcLength.sampleCount(), (unsigned)mesh.railVertices.size(),
+			   fabs(mesh.arcLength.totalLength() - reference), adaptiveError, buildMs);
+	}
+}
+
+//****************************************************************************
+//
+// * "Exact" length of a segment from 0 to t - Gauss-Legendre on 64 pieces
+//============================================================================
+static double referenceLength(const vector<ControlPoint>& points, int splineType,
+							  size_t segment, float t)
+//============================================================================
+{
+	size_t n = points.size();
+	const Pnt3f& p0 = points[segment % n].pos;
+	const Pnt3f& p1 = points[(segment + 1) % n].pos;
+	const Pnt3f& p2 = points[(segment + 2) % n].pos;
+	const Pnt3f& p3 = points[(segment + 3) % n].pos;
+
+	double len = 0;
+	for (int k = 0; k < 64; ++k)
+		len += GMTArcLength(p0, p1, p2, p3, splineType, t * k / 64, t * (k + 1) / 64);
+	return len;
+}
+
+//****************************************************************************
+//
+// * Two questions, on a real track:
+//   - how long is it? chord sums of 20 pieces per segment (what we used to
+//     do) against Gauss-Legendre on whole segments and on the adaptive
+//     pieces. "evals" counts spline (or derivative) evaluations
+//   - where is distance s? walk the track in small steps and see how far
+//     the point found really is from where it should be. The old way is
+//     the chord table with linear interpolation, the new way is Newton
+//============================================================================
+void benchmarkArcLengthIntegration(const char* trackFile)
+//============================================================================
+{
+	const int chordPieces = 20;
+	const double step = 0.25;
+
+	CTrack track;
+	track.readPoints(trackFile);
+	const vector<ControlPoint>& points = track.points;
+	size_t n = points.size();
+
+	printf("Arc length: %s, %u points\n", trackFile, (unsigned)n);
+	for (int splineType = 2; splineType <= 3; ++splineType) {
+		vector<double> segmentStart(n + 1, 0);
+		for (size_t i = 0; i < n; ++i)
+			segmentStart[i + 1] = segmentStart[i] + referenceLength(points, splineType, i, 1);
+		double reference = segmentStart[n];
+
+		// the length, three ways
+		BenchClock::time_point start = BenchClock::now();
+		double chord = 0;
+		for (size_t i = 0; i < n; ++i)
+			chord += uniformLength(points, splineType, i, chordPieces);
+		double chordMs = msSince(start);
+
+		start = BenchClock::now();
+		double gauss = 0;
+		for (size_t i = 0; i < n; ++i)
+			gauss += GMTArcLength(points[i].pos, points[(i + 1) % n].pos,
+								  points[(i + 2) % n].pos, points[(i + 3) % n].pos, splineType, 0, 1);
+		double gaussMs = msSince(start);
+
+		TrackMesh mesh;
+		mesh.update(points, splineType);
+
+		printf("  %s, length %.4f\n", (splineType == 2) ? "cardinal" : "b-spline", reference);
+		printf("    chord sum, %2d/segment : error %10.6f, %6u evals, %.4f ms\n",
+			   chordPieces, fabs(chord - reference), (unsigned)(n * (chordPieces + 1)), chordMs);
+		printf("    gauss, whole segments : error %10.6f, %6u evals, %.4f ms\n",
+			   fabs(gauss - reference), (unsigned)(n * 5), gaussMs);
+		printf("    gauss, adaptive pieces: error %10.6f, %6u evals\n",
+			   fabs(mesh.arcLength.totalLength() - reference), (unsigned)(mesh.arcLength.sampleCount() * 5));
+
+		// distance -> t, two ways
+		ArcLengthIndex chordTable;
+		for (size_t i = 0; i < n; ++i) {
+			const Pnt3f& p0 = points[i].pos;
+			const Pnt3f& p1 = points[(i + 1) % n].pos;
+			const Pnt3f& p2 = points[(i + 2) % n].pos;
+			const Pnt3f& p3 = points[(i + 3) % n].pos;
+			Pnt3f pre = GMT(p0, p1, p2, p3, splineType, 0);
+			for (int j = 0; j < chordPieces; ++j) {
+				float t1 = (float)(j + 1) / chordPieces;
+				Pnt3f q = GMT(p0, p1, p2, p3, splineType, t1);
+				chordTable.addSample((q - pre).getLength(), (int)i, (float)j / chordPieces, t1);
+				pre = q;
+			}
+		}
+
+		// stop short of the end - the chord table is shorter than the track
+		// and we don't want to measure it wrapping around
+		double end = (chordTable.totalLength() < reference) ? chordTable.totalLength() : reference;
+		for (int method = 0; method < 2; ++method) {
+			double worst = 0, jitter = 0, previous = 0, ms = 0;
+			size_t lookups = 0;
+			for (double s = 0; s < end - step; s += step, ++lookups) {
+				int seg;
+				float t;
+				start = BenchClock::now();
+				if (method == 0)
+					chordTable.locate(s, seg, t);
+				else
+					mesh.locate(points, s, seg, t);
+				ms += msSince(start);
+
+				double actual = segmentStart[seg] + referenceLength(points, splineType, seg, t);
+				if (fabs(actual - s) > worst) worst = fabs(actual - s);
+				if (s > 0 && fabs((actual - previous) / step - 1) > jitter)
+					jitter = fabs((actual - previous) / step - 1);
+				previous = actual;
+			}
+			printf("    %s: max position error %9.6f, max speed error %6.3f%%, %.4f us per lookup\n",
+				   (method == 0) ? "chord table + lerp" : "gauss + newton    ",
+				   worst, 100 * jitter, 1000 * ms / lookups);
+		}
+	}
+}
+
+//****************************************************************************
+//
+// * nEvaluations points on a track, spread over its segments, 4 ways:
+//   the old GMT, the new GMT (dispatch per point), a batch per segment
+//   and one batch of (segment, t) pairs for the whole track
+//============================================================================
+void benchmarkSplineKernels(int nEvaluations)
+//============================================================================
+{
+	const int nPoints = 1000;
+	const int perSegment = nEvaluations / nPoints;
+	const int count = perSegment * nPoints;
+
+	vector<ControlPoint> points(nPoints);
+	float radius = 1.5f * nPoints;
+	for (int i = 0; i < nPoints; ++i) {
+		float a = 6.2831853f * i / nPoints;
+		points[i] = ControlPoint(Pnt3f(radius * cos(a), 20.0f + 10.0f * sin(37.0f * a), radius * sin(a)));
+	}
+
+	vector<int> segments(count);
+	vector<float> ts(count);
+	for (int k = 0; k < count; ++k) {
+		segments[k] = k / perSegment;
+		ts[k] = (float)(k % perSegment) / perSegment;
+	}
+	vector<float> x(count), y(count), z(count);
+
+	printf("Spline kernels: %d evaluations on %d segments\n", count, nPoints);
+	for (int splineType = 1; splineType <= 3; ++splineType) {
+		double legacyMs, singleMs, segmentMs, trackMs;
+		double sum = 0, maxDiff = 0;
+
+		BenchClock::time_point start = BenchClock::now();
+		for (int k = 0; k < count; ++k) {
+			int i = segments[k];
+			Pnt3f q = legacyGMT(points[i].pos, points[(i + 1) % nPoints].pos,
+								points[(i + 2) % nPoints].pos, points[(i + 3) % nPoints].pos, splineType, ts[k]);
+			x[k] = q.x; y[k] = q.y; z[k] = q.z;
+		}
+		legacyMs = msSince(start);
+		vector<float> lx(x), ly(y), lz(z);
+
+		start = BenchClock::now();
+		for (int k = 0; k < count; ++k) {
+			int i = segments[k];
+			Pnt3f q = GMT(points[i].pos, points[(i + 1) % nPoints].pos,
+						  points[(i + 2) % nPoints].pos, points[(i + 3) % nPoints].pos, splineType, ts[k]);
+			x[k] = q.x; y[k] = q.y; z[k] = q.z;
+		}
+		singleMs = msSince(start);
+		for (int k = 0; k < count; ++k) sum += x[k];
+
+		start = BenchClock::now();
+		for (int i = 0; i < nPoints; ++i) {
+			size_t first = (size_t)i * perSegment;
+			GMTBatch(points[i].pos, points[(i + 1) % nPoints].pos,
+					 points[(i + 2) % nPoints].pos, points[(i + 3) % nPoints].pos, splineType,
+					 &ts[first], perSegment, &x[first], &y[first], &z[first]);
+		}
+		segmentMs = msSince(start);
+		for (int k = 0; k < count; ++k) sum += y[k];
+
+		start = BenchClock::now();
+		GMTBatch(points, splineType, false, &segments[0], &ts[0], count, &x[0], &y[0], &z[0]);
+		trackMs = msSince(start);
+
+		for (int k = 0; k < count; ++k) {
+			double d = fabs(x[k] - lx[k]) + fabs(y[k] - ly[k]) + fabs(z[k] - lz[k]);
+			if (d > maxDiff) maxDiff = d;
+			sum += z[k];
+		}
+
+		printf("  %s\n", (splineType == 1) ? "linear" : (splineType == 2) ? "cardinal" : "b-spline");
+		printf("    old GMT (glm G*M*T): %8.2f ms\n", legacyMs);
+		printf("    GMT, one at a time : %8.2f ms (%.1fx)\n", singleMs, legacyMs / singleMs);
+		printf("    batch per segment  : %8.2f ms (%.1fx)\n", segmentMs, legacyMs / segmentMs);
+		printf("    batch, whole track : %8.2f ms (%.1fx)\n", trackMs, legacyMs / trackMs);
+		printf("    max difference %g (checksum %g)\n", maxDiff, sum);
+	}
+}
+
+//****************************************************************************
+//
+// * Angle between two unit vectors
+//============================================================================
+static double angleBetween(const Pnt3f& a, const Pnt3f& b)
+//============================================================================
+{
+	double c = a.x * b.x + a.y * b.y + a.z * b.z;
+	if (c > 1) c = 1;
+	if (c < -1) c = -1;
+	return acos(c);
+}
+
+//****************************************************************************
+//
+// * Walk a real track in small steps and get the frame at every step both
+//   ways. "square" is the worst |dot| between two axes of a frame, "roll"
+//   the fastest the up vector turns (radians per unit of track) and "bank"
+//   how far the new up gets from the old one
+//============================================================================
+void benchmarkTrackFrames(const char* trackFile)
+//============================================================================
+{
+	const double step = 0.25;
+
+	CTrack track;
+	track.readPoints(trackFile);
+	const vector<ControlPoint>& points = track.points;
+	size_t n = points.size();
+
+	printf("Track frames: %s, %u points\n", trackFile, (unsigned)n);
+	for (int splineType = 2; splineType <= 3; ++splineType) {
+		TrackMesh mesh;
+		mesh.update(points, splineType);
+		double total = mesh.arcLength.totalLength();
+
+		vector<TrackFrame> frames[2];
+		double ms[2] = { 0, 0 };
+		for (int method = 0; method < 2; ++method) {
+			BenchClock::time_point start = BenchClock::now();
+			for (double s = 0; s < total; s += step) {
+				TrackFrame f;
+				if (method == 0) {
+					int i;
+					float t;
+					mesh.locate(points, s, i, t);
+					const ControlPoint& p0 = points[i % n];
+					const ControlPoint& p1 = points[(i + 1) % n];
+					const ControlPoint& p2 = points[(i + 2) % n];
+					const ControlPoint& p3 = points[(i + 3) % n];
+					f.pos = GMT(p0.pos, p1.pos, p2.pos, p3.pos, splineType, t);
+					Pnt3f ori = GMT(p0.orient, p1.orient, p2.orient, p3.orient, splineType, t);
+					f.forward = GMTTangent(p0.pos, p1.pos, p2.pos, p3.pos, splineType, t);
+					f.forward.normalize();
+					f.side = f.forward * ori;
+					f.side.normalize();
+					f.up = f.side * f.forward;
+					f.up.normalize();
+				}
+				else
+					mesh.arcLength.frameAt(s, f);
+				frames[method].push_back(f);
+			}
+			ms[method] = msSince(start);
+		}
+
+		printf("  %s, length %.4f, %u frames\n", (splineType == 2) ? "cardinal" : "b-spline",
+			   total, (unsigned)frames[0].size());
+		double bank = 0;
+		for (int method = 0; method < 2; ++method) {
+			double square = 0, roll = 0;
+			const vector<TrackFrame>& f = frames[method];
+			for (size_t k = 0; k < f.size(); ++k) {
+				double d[3] = {
+					f[k].forward.x * f[k].up.x + f[k].forward.y * f[k].up.y + f[k].forward.z * f[k].up.z,
+					f[k].forward.x * f[k].side.x + f[k].forward.y * f[k].side.y + f[k].forward.z * f[k].side.z,
+					f[k].up.x * f[k].side.x + f[k].up.y * f[k].side.y + f[k].up.z * f[k].side.z
+				};
+				for (int a = 0; a < 3; ++a)
+					if (fabs(d[a]) > square) square = fabs(d[a]);
+				if (k > 0 && angleBetween(f[k - 1].up, f[k].up) / step > roll)
+					roll = angleBetween(f[k - 1].up, f[k].up) / step;
+				if (method == 1 && angleBetween(frames[0][k].up, f[k].up) > bank)
+					bank = angleBetween(frames[0][k].up, f[k].up);
+			}
+			printf("    %s: square %.2e, roll %.4f rad/unit, %.4f us per frame\n",
+				   (method == 0) ? "locate + cross products" : "frame table            ",
+				   square, roll, 1000 * ms[method] / f.size());
+		}
+		printf("    bank: new up is at most %.4f rad from the old one\n", bank);
+	}
+}
+
+//****************************************************************************
+//
+// * Ride the train camera (same lens as setProjection) around a big loop
+//   and count what is left to draw after the frustum test
+//============================================================================
+void benchmarkChunkCulling(int nPoints)
+//============================================================================
+{
+	const int splineType = 2;
+	const int nViews = 200;
+
+	vector<ControlPoint> points(nPoints);
+	float radius = 1.5f * nPoints;
+	for (int i = 0; i < nPoints; ++i) {
+		float a = 6.2831853f * i / nPoints;
+		points[i] = ControlPoint(Pnt3f(radius * cos(a), 20.0f + 10.0f * sin(37.0f * a), radius * sin(a)));
+	}
+
+	TrackMesh mesh;
+	mesh.update(points, splineType);
+	const vector<TrackChunk>& chunks = mesh.chunks;
+	size_t tiles = mesh.tileTransforms.size() / 16;
+
+	glm::mat4 projection = glm::perspective(glm::radians(30.0f), 4.0f / 3.0f, 0.001f, 500.0f);
+	double cullMs = 0;
+	size_t seenChunks = 0, seenVertices = 0, seenTiles = 0;
+	for (int k = 0; k < nViews; ++k) {
+		TrackFrame f;
+		mesh.arcLength.frameAt(mesh.arcLength.totalLength() * k / nViews, f);
+		Pnt3f eye = f.pos + f.up * 5.0f;
+		Pnt3f at = eye + f.forward * 5.0f;
+		glm::mat4 view = glm::lookAt(glm::vec3(eye.x, eye.y, eye.z), glm::vec3(at.x, at.y, at.z),
+									 glm::vec3(f.up.x, f.up.y, f.up.z));
+
+		BenchClock::time_point start = BenchClock::now();
+		Frustum frustum;
+		frustum.set(&projection[0][0], &view[0][0]);
+		for (size_t c = 0; c < chunks.size(); ++c)
+			if (frustum.intersectsBox(chunks[c].boxMin, chunks[c].boxMax)) {
+				seenChunks++;
+				seenVertices += chunks[c].vertexCount;
+				seenTiles += chunks[c].tileCount;
+			}
+		cullMs += msSince(start);
+	}
+
+	printf("Chunk culling: %d points, length %.0f, %u chunks\n",
+		   nPoints, mesh.arcLength.totalLength(), (unsigned)chunks.size());
+	printf("  drawn per view: %8.1f chunks, %10.0f of %u rail vertices, %8.0f of %u sleepers\n",
+		   (double)seenChunks / nViews, (double)seenVertices / nViews, (unsigned)mesh.railVertices.size(),
+		   (double)seenTiles / nViews, (unsigned)tiles);
+	printf("  culling: %.4f ms per view\n", cullMs / nViews);
+}
+
+//****************************************************************************
+//
+// * A free ride (no lift) from the highest point of the track, so the
+//   train has the energy to get all of the way around
+//============================================================================
+void benchmarkTrainPhysics(const char* trackFile)
+//============================================================================
+{
+	const double seconds = 120;
+
+	CTrack track;
+	track.readPoints(trackFile);
+	TrackMesh mesh;
+	mesh.update(track.points, 2);
+	const ArcLengthIndex& arc = mesh.arcLength;
+
+	double top = 0, topHeight = -1e30;
+	for (double s = 0; s < arc.totalLength(); s += 1) {
+		TrackFrame f;
+		arc.frameAt(s, f);
+		if (f.pos.y > topHeight) {
+			topHeight = f.pos.y;
+			top = s;
+		}
+	}
+
+	printf("Train physics: %s, %.0f s of riding\n", trackFile, seconds);
+	for (int lossy = 0; lossy < 2; ++lossy) {
+		TrainPhysics physics;
+		physics.liftSpeed = 0;
+		if (!lossy)
+			physics.friction = physics.drag = 0;
+		physics.reset(top, 5);
+
+		double start = physics.energy(arc), drift = 0, fastest = 0;
+		BenchClock::time_point clock = BenchClock::now();
+		int steps = 0;
+		for (int frame = 0; frame < seconds * 30; ++frame) {
+			steps += physics.advance(arc, 1.0 / 30);
+			double e = fabs(physics.energy(arc) - start) / start;
+			if (e > drift) drift = e;
+			if (fabs(physics.speed) > fastest) fastest = fabs(physics.speed);
+		}
+		double ms = msSince(clock);
+		printf("  %s: energy %s %.2e, top speed %.1f, %d steps, %.3f us per step\n",
+			   lossy ? "friction + drag" : "frictionless   ", lossy ? "lost " : "drift", drift,
+			   fastest, steps, 1000 * ms / steps);
+	}
+
+	// the same 10 seconds cut into frames of two sizes, pulled forwards
+	// and backwards
+	const int rates[2] = { 30, 144 };
+	for (int back = 0; back < 2; ++back) {
+		double where[2];
+		for (int k = 0; k < 2; ++k) {
+			TrainPhysics physics;
+			if (back)
+				physics.liftSpeed = -physics.liftSpeed;
+			physics.reset(top, 0);
+			for (int frame = 0; frame < 10 * rates[k]; ++frame)
+				physics.advance(arc, 1.0 / rates[k]);
+			where[k] = physics.position;
+		}
+		printf("  after 10 s %s at 30 / 144 fps: %.4f / %.4f\n", back ? "backwards" : "forwards ",
+			   where[0], where[1]);
+	}
+}
+
+//****************************************************************************
+//
+// * The chain lift pushes every train, so only the brakes keep them apart
+//============================================================================
+void benchmarkTrainFleet(const char* trackFile, int nTrains)
+//============================================================================
+{
+	const double seconds = 120;
+
+	CTrack track;
+	track.readPoints(trackFile);
+	TrackMesh mesh;
+	mesh.update(track.points, 2);
+	const ArcLengthIndex& arc = mesh.arcLength;
+
+	TrainFleet fleet;
+	int made = fleet.setTrains(arc, vector<int>(nTrains, 8));
+
+	// halfway through every other train gets 4 more cars and the rest 4
+	// less, which spreads them out again
+	vector<int> mixed(nTrains);
+	for (int i = 0; i < nTrains; ++i)
+		mixed[i] = (i & 1) ? 4 : 12;
+	double closest[2] = { 1e30, 1e30 };
+	size_t braking = 0, samples = 0, released = 0;
+	vector<bool> inZone(fleet.trains.size(), false);
+	BenchClock::time_point clock = BenchClock::now();
+	int steps = 0;
+	for (int frame = 0; frame < seconds * 30; ++frame) {
+		int half = (frame >= seconds * 15) ? 1 : 0;
+		if (frame == seconds * 15)
+			fleet.setTrains(arc, mixed);
+		steps += fleet.advance(arc, 1.0 / 30);
+		inZone.resize(fleet.trains.size(), false);
+		for (size_t i = 0; i < fleet.trains.size(); ++i) {
+			double gap = fleet.gapAhead(arc, i);
+			if (gap < closest[half]) closest[half] = gap;
+			bool zone = gap < fleet.brakeDistance;
+			if (zone) braking++;
+			if (inZone[i] && !zone) released++;
+			inZone[i] = zone;
+			samples++;
+		}
+	}
+	double ms = msSince(clock);
+
+	printf("Train fleet: %s, %d of %d trains, %.0f s of riding\n", trackFile, made, nTrains, seconds);
+	printf("  closest gap %.2f with 8 cars, %.2f with 12 and 4 (min %.0f)\n",
+		   closest[0], closest[1], fleet.minGap);
+	printf("  %.1f%% of the time braking, braking zones left %d times\n",
+		   100.0 * braking / samples, (int)released);
+	printf("  %d steps, %.3f us per step\n", steps, 1000 * ms / steps);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+static bool samePoints(const vector<ControlPoint>& a, const vector<ControlPoint>& b)
+//============================================================================
+{
+	if (a.size() != b.size())
+		return false;
+	for (size_t i = 0; i < a.size(); ++i)
+		if (a[i].pos.x != b[i].pos.x || a[i].pos.y != b[i].pos.y || a[i].pos.z != b[i].pos.z ||
+			a[i].orient.x != b[i].orient.x || a[i].orient.y != b[i].orient.y || a[i].orient.z != b[i].orient.z)
+			return false;
+	return true;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+static long fileBytes(const char* filename)
+//============================================================================
+{
+	FILE* fp = fopen(filename, "rb");
+	if (!fp)
+		return 0;
+	fseek(fp, 0, SEEK_END);
+	long bytes = ftell(fp);
+	fclose(fp);
+	return bytes;
+}
+
+//****************************************************************************
+//
+// * Every load ends with a mesh that is ready to draw. The files go in the
+//   current directory and are removed at the end
+//============================================================================
+void benchmarkTrackLoad(int nPoints)
+//============================================================================
+{
+	const int splineType = 2;
+	const int nLoads = 5;
+	const char* textFile = "benchmark_track.txt";
+	const char* pointsFile = "benchmark_track.trk";
+	const char* meshFile = "benchmark_track_mesh.trk";
+
+	vector<ControlPoint> points(nPoints);
+	float radius = 1.5f * nPoints;
+	for (int i = 0; i < nPoints; ++i) {
+		float a = 6.2831853f * i / nPoints;
+		points[i] = ControlPoint(Pnt3f(radius * cos(a), 20.0f + 10.0f * sin(37.0f * a), radius * sin(a)),
+								 Pnt3f(0.1f * sin(5.0f * a), 1, 0.1f * cos(3.0f * a)));
+	}
+	TrackMesh sampled;
+	sampled.update(points, splineType);
+
+	writeTrackText(textFile, points);
+	writeTrackBinary(pointsFile, points);
+	writeTrackBinary(meshFile, points, &sampled);
+
+	const char* files[3] = { textFile, pointsFile, meshFile };
+	const char* names[3] = { "text          ", "binary        ", "binary + mesh " };
+	double readMs[3] = { 0 }, meshMs[3] = { 0 };
+	vector<ControlPoint> loaded[3];
+	TrackMesh meshes[3];
+	for (int f = 0; f < 3; ++f)
+		for (int k = 0; k < nLoads; ++k) {
+			BenchClock::time_point start = BenchClock::now();
+			readTrackFile(files[f], loaded[f], &meshes[f]);
+			readMs[f] += msSince(start);
+			start = BenchClock::now();
+			meshes[f].update(loaded[f], splineType);
+			meshMs[f] += msSince(start);
+		}
+
+	// mapping the file is all it takes to use the points
+	BenchClock::time_point start = BenchClock::now();
+	double checksum = 0;
+	for (int k = 0; k < nLoads; ++k) {
+		TrackFileView view;
+		view.open(meshFile);
+		const float* pos = view.positions();
+		for (uint32_t i = 0; i < view.header().pointCount; ++i)
+			checksum += pos[3 * i + 1];
+	}
+	double mapMs = msSince(start) / nLoads;
+
+	// text -> binary -> text has to give back the same floats
+	vector<ControlPoint> again;
+	writeTrackText(textFile, loaded[2]);
+	readTrackText(textFile, again);
+	bool roundTrip = samePoints(points, loaded[0]) && samePoints(points, loaded[1]) &&
+					 samePoints(points, loaded[2]) && samePoints(points, again);
+
+	double meshDiff = fabs(meshes[2].arcLength.totalLength() - sampled.arcLength.totalLength());
+	bool sameMesh = meshes[2].railVertices.size() == sampled.railVertices.size() &&
+					meshes[2].tileTransforms == sampled.tileTransforms &&
+					meshes[2].chunks.size() == sampled.chunks.size() &&
+					meshes[2].arcLength.sampleCount() == sampled.arcLength.sampleCount();
+	for (size_t k = 0; sameMesh && k < sampled.railVertices.size(); ++k) {
+		Pnt3f d = meshes[2].railVertices[k] - sampled.railVertices[k];
+		sameMesh = d.x == 0 && d.y == 0 && d.z == 0;
+	}
+
+	printf("Track load: %d points, average of %d loads\n", nPoints, nLoads);
+	for (int f = 0; f < 3; ++f)
+		printf("  %s: %9ld bytes, read %9.3f ms + mesh %9.3f ms = %9.3f ms\n", names[f], fileBytes(files[f]),
+			   readMs[f] / nLoads, meshMs[f] / nLoads, (readMs[f] + meshMs[f]) / nLoads);
+	printf("  map only      : %.3f ms (checksum %g)\n", mapMs, checksum);
+	printf("  points round trip %s, loaded mesh %s (length difference %g)\n",
+		   roundTrip ? "exact" : "DIFFERENT", sameMesh ? "identical" : "DIFFERENT", meshDiff);
+
+	remove(textFile);
+	remove(pointsFile);
+	remove(meshFile);
+}
+
+//****************************************************************************
+//
+// * A unit sphere cut into rings x rings * 2 triangles
+//============================================================================
+static void makeSphere(int rings, vector<float>& vertices, vector<unsigned int>& indices)
+//============================================================================
+{
+	vertices.clear();
+	indices.clear();
+	for (int i = 0; i <= rings; ++i)
+		for (int j = 0; j <= rings; ++j) {
+			float a = 3.14159265f * i / rings, b = 6.2831853f * j / rings;
+			vertices.push_back(sin(a) * cos(b));
+			vertices.push_back(cos(a));
+			vertices.push_back(sin(a) * sin(b));
+		}
+	for (int i = 0; i < rings; ++i)
+		for (int j = 0; j < rings; ++j) {
+			unsigned int k = i * (rings + 1) + j;
+			unsigned int quad[6] = { k, k + rings + 1, k + 1, k + 1, k + rings + 1, k + rings + 2 };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+}
+
+//****************************************************************************
+//
+// * A hit over the start of the track ends past its length
+//============================================================================
+static bool hitNear(const ClearanceHit& hit, double s, double reach, double length)
+//============================================================================
+{
+	return (hit.end >= s - reach && hit.start <= s + reach) ||
+		   (hit.end >= s + length - reach && hit.start <= s + length + reach);
+}
+
+//****************************************************************************
+//
+// * The park is nRides spheres of radius 15 next to the track; every
+//   other one is moved onto it, right where the train rides. Those have
+//   to come back as hits around where they were put, the others not at
+//   all
+//============================================================================
+void benchmarkTrackClearance(const char* trackFile, int nRides, int trianglesPerRide)
+//============================================================================
+{
+	const float radius = 15;
+	const double step = 1.0;
+
+	CTrack track;
+	track.readPoints(trackFile);
+	TrackMesh mesh;
+	mesh.update(track.points, 2);
+	const ArcLengthIndex& arc = mesh.arcLength;
+	double length = arc.totalLength();
+
+	vector<float> vertices;
+	vector<unsigned int> indices;
+	makeSphere((int)sqrt(trianglesPerRide / 2.0), vertices, indices);
+
+	ClearanceEnvelope envelope = trainEnvelope(1.0f);
+	float lift = (envelope.top + envelope.bottom) / 2;
+	vector<double> onTrack;
+	TriangleBVH bvh;
+	for (int r = 0; r < nRides; ++r) {
+		double s = length * (r + 0.5) / nRides;
+		TrackFrame frame;
+		arc.frameAt(s, frame);
+		Pnt3f center = frame.pos + frame.up * lift;
+		if (r % 2)
+			center = center + frame.side * (radius + envelope.halfWidth + 40);
+		else
+			onTrack.push_back(s);
+		glm::mat4 m = glm::translate(glm::mat4(1.0f), glm::vec3(center.x, center.y, center.z));
+		m = glm::scale(m, glm::vec3(radius));
+		bvh.addTriangles(&vertices[0], 3 * sizeof(float), &indices[0], indices.size(), &m[0][0]);
+	}
+
+	BenchClock::time_point start = BenchClock::now();
+	bvh.build();
+	double buildMs = msSince(start);
+
+	vector<ClearanceHit> hits;
+	const int runs = 10;
+	double sweepMs[2];
+	unsigned int threads[2] = { 1, 0 };
+	for (int t = 0; t < 2; ++t) {
+		start = BenchClock::now();
+		for (int k = 0; k < runs; ++k)
+			checkClearance(bvh, arc, envelope, step, threads[t], hits);
+		sweepMs[t] = msSince(start) / runs;
+	}
+
+	// the spheres are hollow, so the train hits one where it goes in and
+	// where it comes out. Every ride on the track has to have a hit within
+	// reach of it, and every hit has to be near a ride on the track
+	double reach = radius + envelope.halfWidth + envelope.top + step;
+	size_t found = 0, stray = 0;
+	for (size_t k = 0; k < onTrack.size(); ++k)
+		for (size_t h = 0; h < hits.size(); ++h)
+			if (hitNear(hits[h], onTrack[k], reach, length)) {
+				found++;
+				break;
+			}
+	for (size_t h = 0; h < hits.size(); ++h) {
+		bool near = false;
+		for (size_t k = 0; k < onTrack.size(); ++k)
+			near = near || hitNear(hits[h], onTrack[k], reach, length);
+		if (!near)
+			stray++;
+	}
+
+	printf("Track clearance: %s (length %.1f), %d rides, %u triangles, %u nodes\n", trackFile, length,
+		   nRides, (unsigned)bvh.triangleCount(), (unsigned)bvh.nodeCount());
+	printf("  build %.3f ms, sweep every %.1f: %.3f ms on 1 thread, %.3f ms on %u\n", buildMs, step,
+		   sweepMs[0], sweepMs[1], std::thread::hardware_concurrency());
+	printf("  %u hits, %u of %u rides on the track found, %u hits with no ride\n", (unsigned)hits.size(),
+		   (unsigned)found, (unsigned)onTrack.size(), (unsigned)stray);
+}
+
+//****************************************************************************
+//
+// * Rays from a camera above a nPoints track down at random control
+//   points (a little off, so some miss). The index has to find the same
+//   nearest point as testing every point, the way GL_SELECT drew every
+//   one of them
+//============================================================================
+void benchmarkPicking(int nPoints, int nRays)
+//============================================================================
+{
+	const int splineType = 2;
+
+	vector<ControlPoint> points(nPoints);
+	float radius = 1.5f * nPoints;
+	for (int i = 0; i < nPoints; ++i) {
+		float a = 6.2831853f * i / nPoints;
+		points[i] = ControlPoint(Pnt3f(radius * cos(a), 20.0f + 10.0f * sin(37.0f * a), radius * sin(a)));
+	}
+	TrackMesh mesh;
+	mesh.update(points, splineType);
+
+	PickIndex index;
+	BenchClock::time_point start = BenchClock::now();
+	index.setTrack(points, mesh);
+	double buildMs = msSince(start);
+
+	vector<Pnt3f> origins(nRays), dirs(nRays);
+	unsigned int seed = 12345;
+	for (int k = 0; k < nRays; ++k) {
+		seed = seed * 1103515245u + 12345u;
+		const Pnt3f& target = points[(seed >> 8) % nPoints].pos;
+		float off = ((seed >> 4) % 9) - 4.0f;
+		origins[k] = target + Pnt3f(30.0f, 200.0f, 10.0f);
+		dirs[k] = target + Pnt3f(off, 0, 0) - origins[k];
+		dirs[k].normalize();
+	}
+
+	vector<PickHit> hits(nRays);
+	start = BenchClock::now();
+	for (int k = 0; k < nRays; ++k)
+		index.pick(origins[k], dirs[k], 1000.0f, hits[k], PICK_CONTROL_POINT);
+	double indexMs = msSince(start);
+
+	int same = 0, found = 0;
+	start = BenchClock::now();
+	for (int k = 0; k < nRays; ++k) {
+		int best = -1;
+		float bestT = 1000.0f;
+		for (int i = 0; i < nPoints; ++i) {
+			Pnt3f w = origins[k] - points[i].pos;
+			float b = w.x * dirs[k].x + w.y * dirs[k].y + w.z * dirs[k].z;
+			float c = w.x * w.x + w.y * w.y + w.z * w.z - index.pointRadius * index.pointRadius;
+			if (b * b - c < 0)
+				continue;
+			float t = -b - sqrtf(b * b - c);
+			if (t < bestT) {
+				bestT = t;
+				best = i;
+			}
+		}
+		if (best >= 0) found++;
+		if (best == (hits[k].kind == PICK_CONTROL_POINT ? hits[k].index : -1)) same++;
+	}
+	double scanMs = msSince(start);
+
+	int track = 0;
+	for (int k = 0; k < nRays; ++k) {
+		PickHit hit;
+		if (index.pick(origins[k], dirs[k], 1000.0f, hit, PICK_TRACK)) track++;
+	}
+
+	printf("Picking: %d points, %u track pieces, %d rays\n", nPoints, (unsigned)mesh.arcLength.sampleCount(), nRays);
+	printf("  index build %.3f ms\n", buildMs);
+	printf("  every point: %10.3f us per pick\n", 1000 * scanMs / nRays);
+	printf("  index      : %10.3f us per pick\n", 1000 * indexMs / nRays);
+	printf("  %d of %d rays hit a point, same nearest point %d of %d, %d hit the track\n",
+		   found, nRays, same, nRays, track);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void runBenchmarks()
+//============================================================================
+{
+	benchmarkArcLengthLookup(10000);
+	benchmarkTrackEdit(65535);
+	benchmarkTessellation("TrackFiles/final.txt");
+	benchmarkArcLengthIntegration("TrackFiles/final.txt");
+	benchmarkSplineKernels(1000000);
+	benchmarkTrackFrames("TrackFiles/final.txt");
+	benchmarkChunkCulling(65535);
+	benchmarkTrainPhysics("TrackFiles/final.txt");
+	benchmarkTrainFleet("TrackFiles/final.txt", 6);
+	benchmarkTrackLoad(65535);
+	benchmarkTrackClearance("TrackFiles/final.txt", 8, 50000);
+	benchmarkPicking(65535, 10000);
+}
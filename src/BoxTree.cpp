@@ -0,0 +1,145 @@
+/************************************************************************
+     File:        BoxTree.cpp
+
+     Comment:     A bounding volume hierarchy over boxes
+
+						See BoxTree.H
+
+     Platform:    Visio Studio.Net 2003/2005
+
+*************************************************************************/
+
+#include "BoxTree.H"
+
+// items in a leaf of the tree
+static const size_t LEAF_SIZE = 4;
+
+//****************************************************************************
+//
+// * Constructor
+//============================================================================
+BoxTree::
+BoxTree()
+//============================================================================
+{
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void BoxTree::
+clear()
+//============================================================================
+{
+	order.clear();
+	nodes.clear();
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void BoxTree::
+build(const vector<float>& boxes)
+//============================================================================
+{
+	size_t count = boxes.size() / 6;
+	order.resize(count);
+	nodes.clear();
+	if (!count)
+		return;
+
+	for (size_t k = 0; k < count; k++)
+		order[k] = (uint32_t)k;
+	nodes.reserve(2 * count / LEAF_SIZE + 1);
+	nodes.push_back(Node());
+	buildNode(0, 0, count, boxes);
+}
+
+//****************************************************************************
+//
+// * Box the items order[first .. first + count), then split them at the
+//   middle one along the longest side of the box of their centers
+//============================================================================
+void BoxTree::
+buildNode(size_t node, size_t first, size_t count, const vector<float>& boxes)
+//============================================================================
+{
+	Node box;
+	float centerMin[3], centerMax[3];
+	for (int r = 0; r < 3; r++) {
+		box.boxMin[r] = centerMin[r] = 1e30f;
+		box.boxMax[r] = centerMax[r] = -1e30f;
+	}
+	for (size_t k = first; k < first + count; k++) {
+		const float* b = &boxes[order[k] * 6];
+		for (int r = 0; r < 3; r++) {
+			box.boxMin[r] = std::min(box.boxMin[r], b[r]);
+			box.boxMax[r] = std::max(box.boxMax[r], b[3 + r]);
+			float center = b[r] + b[3 + r];
+			centerMin[r] = std::min(centerMin[r], center);
+			centerMax[r] = std::max(centerMax[r], center);
+		}
+	}
+
+	if (count <= LEAF_SIZE) {
+		box.first = (uint32_t)first;
+		box.count = (uint32_t)count;
+		nodes[node] = box;
+		return;
+	}
+
+	int axis = 0;
+	for (int r = 1; r < 3; r++)
+		if (centerMax[r] - centerMin[r] > centerMax[axis] - centerMin[axis])
+			axis = r;
+	size_t half = count / 2;
+	std::nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count,
+					 [&](uint32_t a, uint32_t b) {
+						 return boxes[a * 6 + axis] + boxes[a * 6 + 3 + axis] <
+								boxes[b * 6 + axis] + boxes[b * 6 + 3 + axis];
+					 });
+
+	box.count = 0;
+	nodes[node] = box;
+	nodes.push_back(Node());
+	buildNode(node + 1, first, half, boxes);
+	nodes[node].first = (uint32_t)nodes.size();
+	nodes.push_back(Node());
+	buildNode(nodes[node].first, first + half, count - half, boxes);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+size_t BoxTree::
+nodeCount() const
+//============================================================================
+{
+	return nodes.size();
+}
+
+//****************************************************************************
+//
+// * The slab test: the ray is inside of the box between the largest of
+//   the three entering distances and the smallest of the leaving ones
+//============================================================================
+float BoxTree::
+enter(const Node& node, const float origin[3], const float inverse[3], float nearest)
+//============================================================================
+{
+	float t0 = 0, t1 = nearest;
+	for (int r = 0; r < 3; r++) {
+		float a = (node.boxMin[r] - origin[r]) * inverse[r];
+		float b = (node.boxMax[r] - origin[r]) * inverse[r];
+		if (a > b)
+			std::swap(a, b);
+		if (a > t0) t0 = a;
+		if (b < t1) t1 = b;
+		if (t0 > t1)
+			return -1;
+	}
+	return t0;
+}
@@ -44,6 +44,7 @@ void resetCB(Fl_Widget*, TrainWindow* tw)
 	tw->m_Track.resetPoints();
 	tw->trainView->selectedCube = -1;
 	tw->m_Track.trainU = 0;
+	tw->trackChanged();
 	tw->damageMe();
 }
 
@@ -56,6 +57,30 @@ void damageCB(Fl_Widget*, TrainWindow* tw)
 	tw->damageMe();
 }
 
+//***************************************************************************
+//
+// * as many trains as fit - the slider is put back if they don't
+//===========================================================================
+void fleetCB(Fl_Widget*, TrainWindow* tw)
+//===========================================================================
+{
+	vector<int> cars((int)tw->trainCount->value(), (int)tw->carCount->value());
+	int trains = tw->fleet.setTrains(tw->m_Track.mesh.arcLength, cars);
+	tw->trainCount->value(trains);
+	tw->damageMe();
+}
+
+//***************************************************************************
+//
+// * the whole track is sampled again with the new type
+//===========================================================================
+void splineCB(Fl_Widget*, TrainWindow* tw)
+//===========================================================================
+{
+	tw->trackChanged();
+	tw->damageMe();
+}
+
 //***************************************************************************
 //
 // * Callback that adds a new point to the spline
@@ -74,6 +99,7 @@ void addPointCB(Fl_Widget*, TrainWindow* tw)
 	Pnt3f npos = (tw->m_Track.points[previdx].pos + tw->m_Track.points[newidx].pos) * .5f;
 
 	tw->m_Track.points.insert(tw->m_Track.points.begin() + newidx,npos);
+	tw->m_Track.mesh.markDirty();
 
 	// make it so that the train doesn't move - unless its affected by this control point
 	// it should stay between the same points
@@ -82,6 +108,7 @@ void addPointCB(Fl_Widget*, TrainWindow* tw)
 		if (tw->m_Track.trainU >= npts) tw->m_Track.trainU -= npts;
 	}
 
+	tw->trackChanged();
 	tw->damageMe();
 }
 
@@ -97,6 +124,8 @@ void deletePointCB(Fl_Widget*, TrainWindow* tw)
 			tw->m_Track.points.erase(tw->m_Track.points.begin() + tw->trainView->selectedCube);
 		} else
 			tw->m_Track.points.pop_back();
+		tw->m_Track.mesh.markDirty();
+		tw->trackChanged();
 	}
 	tw->damageMe();
 }
@@ -151,10 +180,13 @@ void loadCB(Fl_Widget*, TrainWindow* tw)
 //===========================================================================
 {
 	const char* fname = 
-		fl_file_chooser("Pick a Track File","*.txt","TrackFiles/track.txt");
+		fl_file_chooser("Pick a Track File","*.{txt,trk}","TrackFiles/track.txt");
 	if (fname) {
 		tw->m_Track.readPoints(fname);
-		tw->damageMe();
+
+		// the trains that fit on the old track may not fit on this one
+		tw->m_Track.mesh.update(tw->m_Track.points, tw->splineBrowser->value());
+		fleetCB(0, tw);
 	}
 }
 //***************************************************************************
@@ -165,7 +197,7 @@ void saveCB(Fl_Widget*, TrainWindow* tw)
 //===========================================================================
 {
 	const char* fname = 
-		fl_input("File name for save (should be *.txt)","TrackFiles/");
+		fl_input("File name for save (*.txt, or *.trk for binary)","TrackFiles/");
 	if (fname)
 		tw->m_Track.writePoints(fname);
 }
@@ -183,6 +215,8 @@ void rollx(TrainWindow* tw, float dir)
 		float co = cos(((float)M_PI_4) * dir);
 		tw->m_Track.points[s].orient.y = co * old.y - si * old.z;
 		tw->m_Track.points[s].orient.z = si * old.y + co * old.z;
+		tw->m_Track.mesh.markDirty();
+		tw->trackChanged();
 	}
 	tw->damageMe();
 } 
@@ -223,6 +257,8 @@ void rollz(TrainWindow* tw, float dir)
 
 		tw->m_Track.points[s].orient.y = co * old.y - si * old.x;
 		tw->m_Track.points[s].orient.x = si * old.y + co * old.x;
+		tw->m_Track.mesh.markDirty();
+		tw->trackChanged();
 	}
 
 	tw->damageMe();
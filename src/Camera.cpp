@@ -0,0 +1,86 @@
+/************************************************************************
+     File:        Camera.cpp
+
+     Comment:     Where the camera is this frame
+
+						See Camera.H
+
+     Platform:    Visio Studio.Net 2003/2005
+
+*************************************************************************/
+
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Camera.H"
+
+//****************************************************************************
+//
+// * Constructor
+//============================================================================
+Camera::
+Camera()
+	: projection(1.0f), view(1.0f), eye(0, 0, 0)
+//============================================================================
+{
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void Camera::
+perspective(float fovy, float aspect, float zNear, float zFar)
+//============================================================================
+{
+	projection = glm::perspective(glm::radians(fovy), aspect, zNear, zFar);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void Camera::
+ortho(float left, float right, float bottom, float top, float zNear, float zFar)
+//============================================================================
+{
+	projection = glm::ortho(left, right, bottom, top, zNear, zFar);
+}
+
+//****************************************************************************
+//
+// * The eye is known here, so nothing has to be inverted
+//============================================================================
+void Camera::
+lookAt(const glm::vec3& from, const glm::vec3& center, const glm::vec3& up)
+//============================================================================
+{
+	view = glm::lookAt(from, center, up);
+	eye = from;
+}
+
+//****************************************************************************
+//
+// * The eye is where the inverse of the view takes the origin
+//============================================================================
+void Camera::
+setView(const glm::mat4& matrix)
+//============================================================================
+{
+	view = matrix;
+	eye = glm::vec3(glm::inverse(view)[3]);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void Camera::
+load() const
+//============================================================================
+{
+	glMatrixMode(GL_PROJECTION);
+	glLoadMatrixf(&projection[0][0]);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadMatrixf(&view[0][0]);
+}
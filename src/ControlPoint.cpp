@@ -24,12 +24,18 @@
 
 *************************************************************************/
 
+// TRACK_HEADLESS builds (the track analysis tool) have no OpenGL, so no
+// draw() either
+#ifndef TRACK_HEADLESS
 #include <windows.h>
 #include <GL/gl.h>
+#endif
 #include <math.h>
 
 #include "ControlPoint.H"
+#ifndef TRACK_HEADLESS
 #include "Utilities/3dUtils.h"
+#endif
 
 //****************************************************************************
 //
@@ -65,6 +71,7 @@ ControlPoint(const Pnt3f &_pos, const Pnt3f &_orient)
 	orient.normalize();
 }
 
+#ifndef TRACK_HEADLESS
 //****************************************************************************
 //
 // * Draw the control point
@@ -130,4 +137,5 @@ draw()
 			glVertex3f( size, size , size);
 		glEnd();
 	glPopMatrix();
-}
\ No newline at end of file
+}
+#endif
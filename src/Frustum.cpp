@@ -0,0 +1,93 @@
+/************************************************************************
+     File:        Frustum.cpp
+
+     Comment:     The part of the world the camera can see
+
+						See Frustum.H
+
+     Platform:    Visio Studio.Net 2003/2005
+
+*************************************************************************/
+
+#include <math.h>
+
+#include "Frustum.H"
+
+//****************************************************************************
+//
+// * Constructor - every plane is 0 x + 0 y + 0 z + 1, which passes anything
+//============================================================================
+Frustum::
+Frustum()
+//============================================================================
+{
+	for (int p = 0; p < 6; p++) {
+		planes[p][0] = planes[p][1] = planes[p][2] = 0;
+		planes[p][3] = 1;
+	}
+}
+
+//****************************************************************************
+//
+// * The rows of clip = projection * view give the planes: left and right
+//   are row 3 +- row 0, bottom and top row 3 +- row 1, near and far row 3
+//   +- row 2
+//============================================================================
+void Frustum::
+set(const float projection[16], const float view[16])
+//============================================================================
+{
+	float clip[16];
+	for (int c = 0; c < 4; c++)
+		for (int r = 0; r < 4; r++) {
+			float sum = 0;
+			for (int k = 0; k < 4; k++)
+				sum += projection[k * 4 + r] * view[c * 4 + k];
+			clip[c * 4 + r] = sum;
+		}
+
+	for (int p = 0; p < 6; p++) {
+		int row = p / 2;
+		float sign = (p % 2) ? -1.0f : 1.0f;
+		for (int k = 0; k < 4; k++)
+			planes[p][k] = clip[k * 4 + 3] + sign * clip[k * 4 + row];
+
+		float length = sqrtf(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] +
+							 planes[p][2] * planes[p][2]);
+		if (length > 0)
+			for (int k = 0; k < 4; k++)
+				planes[p][k] /= length;
+	}
+}
+
+//****************************************************************************
+//
+// * Test the corner of the box that is furthest along each plane's normal
+//============================================================================
+bool Frustum::
+intersectsBox(const Pnt3f& boxMin, const Pnt3f& boxMax) const
+//============================================================================
+{
+	for (int p = 0; p < 6; p++) {
+		float x = (planes[p][0] >= 0) ? boxMax.x : boxMin.x;
+		float y = (planes[p][1] >= 0) ? boxMax.y : boxMin.y;
+		float z = (planes[p][2] >= 0) ? boxMax.z : boxMin.z;
+		if (planes[p][0] * x + planes[p][1] * y + planes[p][2] * z + planes[p][3] < 0)
+			return false;
+	}
+	return true;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+bool Frustum::
+intersectsSphere(const Pnt3f& center, float radius) const
+//============================================================================
+{
+	for (int p = 0; p < 6; p++)
+		if (planes[p][0] * center.x + planes[p][1] * center.y + planes[p][2] * center.z + planes[p][3] < -radius)
+			return false;
+	return true;
+}
@@ -0,0 +1,156 @@
+/************************************************************************
+     File:        GeometryPool.cpp
+
+     Comment:     The models of the rides, in one vertex and one index
+                  buffer
+
+						See GeometryPool.H
+
+     Platform:    Visio Studio.Net 2003/2005
+
+*************************************************************************/
+
+#include <stddef.h>
+
+#include "GeometryPool.H"
+
+//****************************************************************************
+//
+// * Constructor
+//============================================================================
+GeometryPool::
+GeometryPool()
+	: packedVertices(0), packedIndices(0), vao(0), vbo(0), ebo(0)
+//============================================================================
+{
+}
+
+//****************************************************************************
+//
+// * A model that was packed already is left where it is
+//============================================================================
+void GeometryPool::
+add(Model* model)
+//============================================================================
+{
+	if (!model)
+		return;
+	for (size_t m = 0; m < models.size(); m++)
+		if (models[m] == model)
+			return;
+	models.push_back(model);
+
+	for (size_t j = 0; j < model->meshes.size(); j++) {
+		Mesh& mesh = model->meshes[j];
+		mesh.baseVertex = (int)vertices.size();
+		mesh.firstIndex = (unsigned int)indices.size();
+		vertices.insert(vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+		indices.insert(indices.end(), mesh.indices.begin(), mesh.indices.end());
+	}
+}
+
+//****************************************************************************
+//
+// * The vertices and indices are only kept on the card
+//============================================================================
+void GeometryPool::
+build()
+//============================================================================
+{
+	if (vao || vertices.empty())
+		return;
+
+	glGenVertexArrays(1, &vao);
+	glGenBuffers(1, &vbo);
+	glGenBuffers(1, &ebo);
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	glBindVertexArray(vao);
+	bindVertexAttributes();
+	glBindVertexArray(0);
+
+	for (size_t m = 0; m < models.size(); m++)
+		for (size_t j = 0; j < models[m]->meshes.size(); j++) {
+			Mesh& mesh = models[m]->meshes[j];
+			glDeleteVertexArrays(1, &mesh.VAO);
+			glDeleteBuffers(1, &mesh.VBO);
+			glDeleteBuffers(1, &mesh.EBO);
+			mesh.VAO = mesh.VBO = mesh.EBO = 0;
+		}
+
+	packedVertices = vertices.size();
+	packedIndices = indices.size();
+	vertices = vector<Vertex>();
+	indices = vector<unsigned int>();
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+bool GeometryPool::
+built() const
+//============================================================================
+{
+	return vao != 0;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+GLuint GeometryPool::
+vertexArray() const
+//============================================================================
+{
+	return vao;
+}
+
+//****************************************************************************
+//
+// * The same layout as Mesh::setupMesh
+//============================================================================
+void GeometryPool::
+bindVertexAttributes() const
+//============================================================================
+{
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+size_t GeometryPool::
+vertexCount() const
+//============================================================================
+{
+	return packedVertices;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+size_t GeometryPool::
+indexCount() const
+//============================================================================
+{
+	return packedIndices;
+}
@@ -19,15 +19,14 @@ void Mesh::Draw(Shader* shader)
     for (unsigned int i = 0; i < textures.size(); i++)
     {
         glActiveTexture(GL_TEXTURE0 + i); // activate proper texture unit before binding
-        // retrieve texture number (the N in diffuse_textureN)
-        string number;
-        string name = textures[i].type;
-        if (name == "texture_diffuse")
-            number = std::to_string(diffuseNr++);
-        else if (name == "texture_specular")
-            number = std::to_string(specularNr++);
-        string tex_var = (name + number);
-        glUniform1i(glGetUniformLocation(shader->Program, tex_var.c_str()), i);
+        // the N in texture_diffuseN was looked up when the shader was made
+        GLint location = -1;
+        const string& name = textures[i].type;
+        if (name == "texture_diffuse" && diffuseNr <= Shader::MAX_MESH_TEXTURES)
+            location = shader->diffuseMaps[diffuseNr++ - 1];
+        else if (name == "texture_specular" && specularNr <= Shader::MAX_MESH_TEXTURES)
+            location = shader->specularMaps[specularNr++ - 1];
+        shader->setInt(location, i);
 
         //shader.setFloat(("material." + name + number).c_str(), i);
         glBindTexture(GL_TEXTURE_2D, textures[i].id);
@@ -44,6 +44,15 @@ public:
     Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures);
     void Draw(Shader* shader);
     unsigned int VAO, VBO, EBO;
+    // where the mesh went in the GeometryPool it was packed into; -1 if
+    // it wasn't, and is still drawn from its own VAO
+    int baseVertex = -1;
+    unsigned int firstIndex = 0;
+    // the box and a ball around the vertices, in the space of the mesh,
+    // made when it is loaded (see Model::processMesh)
+    glm::vec3 boxMin = glm::vec3(0.0f), boxMax = glm::vec3(0.0f);
+    glm::vec3 sphereCenter = glm::vec3(0.0f);
+    float sphereRadius = 0;
 private:
     //  render data
    
@@ -59,6 +59,7 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene)
 	vector<unsigned int> indices;
 	vector<Texture> textures;
 
+	glm::vec3 boxMin(0.0f), boxMax(0.0f);
 	for (unsigned int i = 0; i < mesh->mNumVertices; i++)
 	{
 		Vertex vertex;
@@ -68,6 +69,8 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene)
 		vector.y = mesh->mVertices[i].y;
 		vector.z = mesh->mVertices[i].z;
 		vertex.Position = vector;
+		boxMin = i ? glm::min(boxMin, vector) : vector;
+		boxMax = i ? glm::max(boxMax, vector) : vector;
 
 		if (mesh->HasNormals())
 		{
@@ -113,7 +116,15 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene)
 
 	//cout << vertices.size() << " " << indices.size() << " " << textures.size() << endl;
 
-	return Mesh(vertices, indices, textures);
+	// the ball is around the middle of the box, just big enough for the
+	// vertex furthest from it
+	Mesh result(vertices, indices, textures);
+	result.boxMin = boxMin;
+	result.boxMax = boxMax;
+	result.sphereCenter = (boxMin + boxMax) * 0.5f;
+	for (size_t i = 0; i < vertices.size(); i++)
+		result.sphereRadius = glm::max(result.sphereRadius, glm::length(vertices[i].Position - result.sphereCenter));
+	return result;
 }
 
 vector<Texture> Model::loadMaterialTextures(aiMaterial* mat, aiTextureType type, string typeName)
@@ -0,0 +1,174 @@
+/************************************************************************
+     File:        PickBuffer.cpp
+
+     Comment:     What is under the mouse, as the card drew it
+
+						See PickBuffer.H
+
+     Platform:    Visio Studio.Net 2003/2005
+
+*************************************************************************/
+
+#include <algorithm>
+
+#include "PickBuffer.H"
+
+//****************************************************************************
+//
+// * Constructor. Nothing is made on the card until begin()
+//============================================================================
+PickBuffer::
+PickBuffer()
+	: radius(2), pbo(0), fence(0), width(0), height(0), readX(0), readY(0), readWidth(0), readHeight(0)
+//============================================================================
+{
+	fbo.fbo = 0;
+	for (int t = 0; t < MAX_FBO_TEXTURE_AMOUNT; t++)
+		fbo.textures[t] = 0;
+	fbo.rbo = 0;
+}
+
+//****************************************************************************
+//
+// * The ids go in an R32UI texture, which can't be blended or filtered -
+//   neither is needed
+//============================================================================
+void PickBuffer::
+begin(int w, int h)
+//============================================================================
+{
+	if (!fbo.fbo) {
+		glGenFramebuffers(1, &fbo.fbo);
+		glGenTextures(1, &fbo.textures[0]);
+		glGenRenderbuffers(1, &fbo.rbo);
+		glGenBuffers(1, &pbo);
+	}
+	if (w != width || h != height) {
+		width = w;
+		height = h;
+
+		glBindTexture(GL_TEXTURE_2D, fbo.textures[0]);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, width, height, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		glBindRenderbuffer(GL_RENDERBUFFER, fbo.rbo);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo.fbo);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, fbo.textures[0], 0);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, fbo.rbo);
+
+		int side = 2 * radius + 1;
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+		glBufferData(GL_PIXEL_PACK_BUFFER, side * side * sizeof(GLuint), 0, GL_STREAM_READ);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo.fbo);
+	glViewport(0, 0, width, height);
+	GLuint nothing[4] = { 0, 0, 0, 0 };
+	glClearBufferuiv(GL_COLOR, 0, nothing);
+	glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void PickBuffer::
+end()
+//============================================================================
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+//****************************************************************************
+//
+// * The read goes into pbo, so glReadPixels returns at once; the fence
+//   tells poll() when the card has got to it
+//============================================================================
+void PickBuffer::
+requestRead(int x, int y)
+//============================================================================
+{
+	if (fence) {
+		glDeleteSync(fence);
+		fence = 0;
+	}
+	if (!fbo.fbo || x < 0 || y < 0 || x >= width || y >= height)
+		return;
+
+	int x0 = std::max(0, x - radius), y0 = std::max(0, y - radius);
+	readWidth = std::min(width, x + radius + 1) - x0;
+	readHeight = std::min(height, y + radius + 1) - y0;
+	readX = x - x0;
+	readY = y - y0;
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo.fbo);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glReadPixels(x0, y0, readWidth, readHeight, GL_RED_INTEGER, GL_UNSIGNED_INT, 0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+	fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	// make sure the commands are on their way, or the fence may never go
+	glFlush();
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+bool PickBuffer::
+pending() const
+//============================================================================
+{
+	return fence != 0;
+}
+
+//****************************************************************************
+//
+// * A timeout of 0 only looks at the fence. Of the ids in the window the
+//   one nearest to the middle wins. A failed wait counts as finished, so
+//   the read isn't waited for forever
+//============================================================================
+bool PickBuffer::
+poll(unsigned int& id)
+//============================================================================
+{
+	if (!fence)
+		return false;
+	GLenum status = glClientWaitSync(fence, 0, 0);
+	if (status == GL_TIMEOUT_EXPIRED)
+		return false;
+	glDeleteSync(fence);
+	fence = 0;
+
+	// a fence that failed will never be signalled: nothing was hit
+	id = 0;
+	if (status == GL_WAIT_FAILED)
+		return true;
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+	const GLuint* pixels = (const GLuint*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+														   readWidth * readHeight * sizeof(GLuint), GL_MAP_READ_BIT);
+	if (pixels) {
+		int best = -1;
+		for (int y = 0; y < readHeight; y++)
+			for (int x = 0; x < readWidth; x++) {
+				GLuint value = pixels[y * readWidth + x];
+				int distance = (x - readX) * (x - readX) + (y - readY) * (y - readY);
+				if (value && (best < 0 || distance < best)) {
+					best = distance;
+					id = value;
+				}
+			}
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	return true;
+}
@@ -0,0 +1,221 @@
+/************************************************************************
+     File:        PickIndex.cpp
+
+     Comment:     What is under the mouse?
+
+						See PickIndex.H
+
+     Platform:    Visio Studio.Net 2003/2005
+
+*************************************************************************/
+
+#include <math.h>
+
+#include "PickIndex.H"
+
+//****************************************************************************
+//
+// *
+//============================================================================
+static float dot(const Pnt3f& a, const Pnt3f& b)
+//============================================================================
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+//****************************************************************************
+//
+// * Add the box around a ball at a and one at b, both of radius r
+//============================================================================
+static void addBox(vector<float>& boxes, const Pnt3f& a, const Pnt3f& b, float r)
+//============================================================================
+{
+	boxes.push_back(((a.x < b.x) ? a.x : b.x) - r);
+	boxes.push_back(((a.y < b.y) ? a.y : b.y) - r);
+	boxes.push_back(((a.z < b.z) ? a.z : b.z) - r);
+	boxes.push_back(((a.x > b.x) ? a.x : b.x) + r);
+	boxes.push_back(((a.y > b.y) ? a.y : b.y) + r);
+	boxes.push_back(((a.z > b.z) ? a.z : b.z) + r);
+}
+
+//****************************************************************************
+//
+// * Constructor - the control points are cubes 4 across, the track is a
+//   bit wider than the sleepers
+//============================================================================
+PickIndex::
+PickIndex()
+	: pointRadius(3.0f), trackRadius(4.0f), pointCount(0), rides(0)
+//============================================================================
+{
+}
+
+//****************************************************************************
+//
+// * A piece goes from the frame at its start to the start of the next
+//   one; the last one to wherever the track ends
+//============================================================================
+void PickIndex::
+setTrack(const vector<ControlPoint>& points, const TrackMesh& mesh)
+//============================================================================
+{
+	const ArcLengthIndex& arc = mesh.arcLength;
+	pointCount = points.size();
+	centers.resize(pointCount);
+	pieceEnds.clear();
+	pieceSegment.clear();
+	pieceDistance.clear();
+
+	vector<float> boxes;
+	boxes.reserve((pointCount + arc.sampleCount()) * 6);
+	for (size_t i = 0; i < pointCount; i++) {
+		centers[i] = points[i].pos;
+		addBox(boxes, centers[i], centers[i], pointRadius);
+	}
+
+	size_t pieces = arc.sampleCount();
+	if (pieces) {
+		const double* prefix;
+		const int* segments;
+		const float* t0;
+		const float* t1;
+		const TrackFrame* frames;
+		arc.getTables(prefix, segments, t0, t1, frames);
+		TrackFrame last;
+		arc.frameAt(arc.totalLength(), last);
+
+		pieceEnds.reserve(2 * pieces);
+		pieceSegment.reserve(pieces);
+		pieceDistance.reserve(2 * pieces);
+		for (size_t k = 0; k < pieces; k++) {
+			const Pnt3f& a = frames[k].pos;
+			const Pnt3f& b = (k + 1 < pieces) ? frames[k + 1].pos : last.pos;
+			pieceEnds.push_back(a);
+			pieceEnds.push_back(b);
+			pieceSegment.push_back(segments[k]);
+			pieceDistance.push_back(prefix[k]);
+			pieceDistance.push_back(prefix[k + 1]);
+			addBox(boxes, a, b, trackRadius);
+		}
+	}
+	tree.build(boxes);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void PickIndex::
+setRides(const TriangleBVH* bvh)
+//============================================================================
+{
+	rides = bvh;
+}
+
+//****************************************************************************
+//
+// * Balls are hit where the ray goes into them. For a piece of track the
+//   ray's closest approach to the piece has to be within trackRadius, and
+//   it is hit that much before the closest approach
+//============================================================================
+bool PickIndex::
+pick(const Pnt3f& origin, const Pnt3f& dir, float maxDistance, PickHit& hit, unsigned int kinds) const
+//============================================================================
+{
+	hit.kind = PICK_NOTHING;
+	hit.index = -1;
+	hit.distance = maxDistance;
+	hit.trackDistance = 0;
+
+	// the nearest of each kind
+	float pointNearest = maxDistance, trackNearest = maxDistance;
+	int pointFound = -1, trackFound = -1;
+	float trackAlong = 0;
+
+	float o[3] = { origin.x, origin.y, origin.z };
+	float d[3] = { dir.x, dir.y, dir.z };
+	float nearest = maxDistance;
+	tree.raycast(o, d, nearest, [&](uint32_t item, float& best) {
+		if (item < pointCount) {
+			if (!(kinds & PICK_CONTROL_POINT))
+				return;
+			Pnt3f w = origin - centers[item];
+			float b = dot(w, dir);
+			float c = dot(w, w) - pointRadius * pointRadius;
+			float disc = b * b - c;
+			if (disc < 0)
+				return;
+			float t = -b - sqrtf(disc);
+			if (t < 0)
+				t = 0;
+			if (t < pointNearest) {
+				pointNearest = t;
+				pointFound = (int)item;
+			}
+		}
+		else {
+			if (!(kinds & PICK_TRACK))
+				return;
+			size_t piece = item - pointCount;
+			const Pnt3f& a = pieceEnds[2 * piece];
+			Pnt3f e = pieceEnds[2 * piece + 1] - a;
+			Pnt3f w = origin - a;
+			float B = dot(dir, e), C = dot(e, e), D = dot(dir, w), E = dot(e, w);
+
+			// closest points of the ray (origin + s dir) and the piece
+			// (a + u e), with s >= 0 and u in [0, 1]
+			float u = (C - B * B > 1e-12f) ? (E - D * B) / (C - B * B) : 0;
+			u = (u < 0) ? 0 : ((u > 1) ? 1 : u);
+			float s = u * B - D;
+			if (s < 0) {
+				s = 0;
+				u = (C > 0) ? E / C : 0;
+				u = (u < 0) ? 0 : ((u > 1) ? 1 : u);
+			}
+			Pnt3f gap = w + dir * s - e * u;
+			float d2 = dot(gap, gap);
+			if (d2 > trackRadius * trackRadius)
+				return;
+			float t = s - sqrtf(trackRadius * trackRadius - d2);
+			if (t < 0)
+				t = 0;
+			if (t < trackNearest) {
+				trackNearest = t;
+				trackFound = (int)piece;
+				trackAlong = u;
+			}
+		}
+		// a point a little behind the track can still win, so only cut
+		// the walk off past that
+		float reach = ((pointNearest < trackNearest) ? pointNearest : trackNearest) + pointRadius;
+		if (reach < best)
+			best = reach;
+	});
+
+	if (pointFound >= 0 && (trackFound < 0 || pointNearest <= trackNearest + pointRadius)) {
+		hit.kind = PICK_CONTROL_POINT;
+		hit.index = pointFound;
+		hit.distance = pointNearest;
+	}
+	else if (trackFound >= 0) {
+		hit.kind = PICK_TRACK;
+		hit.index = pieceSegment[trackFound];
+		hit.distance = trackNearest;
+		hit.trackDistance = pieceDistance[2 * trackFound] +
+							trackAlong * (pieceDistance[2 * trackFound + 1] - pieceDistance[2 * trackFound]);
+	}
+
+	float rideDistance;
+	int owner;
+	if ((kinds & PICK_RIDE) && rides && rides->raycast(origin, dir, hit.distance, rideDistance, owner)) {
+		// only if it is in front of whatever was hit already
+		if (hit.kind == PICK_NOTHING || rideDistance < hit.distance) {
+			hit.kind = PICK_RIDE;
+			hit.index = owner;
+			hit.distance = rideDistance;
+		}
+	}
+
+	hit.point = origin + dir * hit.distance;
+	return hit.kind != PICK_NOTHING;
+}
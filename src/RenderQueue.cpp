@@ -0,0 +1,363 @@
+/************************************************************************
+     File:        RenderQueue.cpp
+
+     Comment:     The models of the park, drawn in the cheapest order
+
+						See RenderQueue.H
+
+     Platform:    Visio Studio.Net 2003/2005
+
+*************************************************************************/
+
+#include <algorithm>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <glm/gtc/matrix_inverse.hpp>
+
+#include "RenderQueue.H"
+
+//****************************************************************************
+//
+// * Constructor. The buffers are made on the first flush()
+//============================================================================
+RenderQueue::
+RenderQueue()
+	: frustum(0), culledItems(0), culledTriangles(0), vao(0), objectBuffer(0), commandBuffer(0),
+	  drawMode(DRAW_INDIRECT)
+//============================================================================
+{
+	memset(&counters, 0, sizeof(counters));
+}
+
+//****************************************************************************
+//
+// * The normal matrix is made here, once for all of the meshes
+//============================================================================
+int RenderQueue::
+addObject(Shader* shader, const glm::mat4& model, float diffuse, float specular)
+//============================================================================
+{
+	Object object;
+	object.model = model;
+	object.normalMatrix = glm::inverseTranspose(glm::mat3(model));
+	object.diffuse = diffuse;
+	object.specular = specular;
+	objects.push_back(object);
+	shaders.push_back(shader);
+	return (int)objects.size() - 1;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void RenderQueue::
+setFrustum(const Frustum* f)
+//============================================================================
+{
+	frustum = f;
+}
+
+//****************************************************************************
+//
+// * The ball is cheaper, so it goes first: its middle moves with the
+//   matrix and it grows with the largest scale of it. A ball that is in
+//   sight can still be around a box that isn't, so then the box is
+//   tried: the box around the turned box of the mesh
+//============================================================================
+bool RenderQueue::
+inSight(const Object& object, const Mesh& mesh) const
+//============================================================================
+{
+	const glm::mat4& m = object.model;
+	glm::vec3 center = glm::vec3(m * glm::vec4(mesh.sphereCenter, 1.0f));
+	float scale = glm::max(glm::length(glm::vec3(m[0])), glm::max(glm::length(glm::vec3(m[1])),
+																  glm::length(glm::vec3(m[2]))));
+	if (!frustum->intersectsSphere(Pnt3f(center.x, center.y, center.z), mesh.sphereRadius * scale))
+		return false;
+
+	glm::vec3 middle = glm::vec3(m * glm::vec4((mesh.boxMin + mesh.boxMax) * 0.5f, 1.0f));
+	glm::vec3 half = (mesh.boxMax - mesh.boxMin) * 0.5f;
+	glm::vec3 reach(0.0f);
+	for (int k = 0; k < 3; k++)
+		reach += glm::abs(glm::vec3(m[k])) * half[k];
+	glm::vec3 lo = middle - reach, hi = middle + reach;
+	return frustum->intersectsBox(Pnt3f(lo.x, lo.y, lo.z), Pnt3f(hi.x, hi.y, hi.z));
+}
+
+//****************************************************************************
+//
+// * One instance of the object, picked out by the base instance
+//============================================================================
+GLuint* RenderQueue::
+submit(Pass pass, int object, const Mesh& mesh, const GLuint* textures, int textureCount, int sampler)
+//============================================================================
+{
+	if (frustum && !inSight(objects[object], mesh)) {
+		culledItems++;
+		culledTriangles += (unsigned int)mesh.indices.size() / 3;
+		return 0;
+	}
+
+	Item item;
+	item.pass = pass;
+	item.shader = shaders[object];
+	item.program = item.shader->Program;
+	for (int t = 0; t < MAX_TEXTURES; t++)
+		item.textures[t] = (t < textureCount) ? textures[t] : 0;
+	item.sampler = sampler;
+	item.object = object;
+	item.command.count = (GLuint)mesh.indices.size();
+	item.command.instanceCount = 1;
+	item.command.firstIndex = mesh.firstIndex;
+	item.command.baseVertex = mesh.baseVertex;
+	item.command.baseInstance = (GLuint)object;
+	items.push_back(item);
+	return items.back().textures;
+}
+
+//****************************************************************************
+//
+// * Pass first, then program, then the textures unit by unit, then the
+//   sampler. The object last, so the meshes of one stay together
+//============================================================================
+bool RenderQueue::
+drawsBefore(const Item& a, const Item& b)
+//============================================================================
+{
+	if (a.pass != b.pass)
+		return a.pass < b.pass;
+	if (a.program != b.program)
+		return a.program < b.program;
+	for (int t = 0; t < MAX_TEXTURES; t++)
+		if (a.textures[t] != b.textures[t])
+			return a.textures[t] < b.textures[t];
+	if (a.sampler != b.sampler)
+		return a.sampler < b.sampler;
+	return a.object < b.object;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+bool RenderQueue::
+sameRun(const Item& a, const Item& b)
+//============================================================================
+{
+	return a.pass == b.pass && a.program == b.program && a.sampler == b.sampler &&
+		   !memcmp(a.textures, b.textures, sizeof(a.textures));
+}
+
+//****************************************************************************
+//
+// * Attributes 0 - 2 from the pool, 3 - 10 from objectBuffer, one Object
+//   per instance. A mat4 takes 4 locations and a mat3 3, a column each
+//============================================================================
+void RenderQueue::
+makeVertexArray(const GeometryPool& pool)
+//============================================================================
+{
+	if (GLAD_GL_VERSION_4_3)
+		drawMode = DRAW_INDIRECT;
+	else if (GLAD_GL_VERSION_4_2)
+		drawMode = DRAW_BASE_INSTANCE;
+	else
+		drawMode = DRAW_BASE_VERTEX;
+	if (drawMode != DRAW_INDIRECT)
+		printf("render queue: no OpenGL 4.3 (glMultiDrawElementsIndirect), drawing one mesh at a time\n");
+
+	glGenVertexArrays(1, &vao);
+	glGenBuffers(1, &objectBuffer);
+	glGenBuffers(1, &commandBuffer);
+
+	glBindVertexArray(vao);
+	pool.bindVertexAttributes();
+
+	glBindBuffer(GL_ARRAY_BUFFER, objectBuffer);
+	for (int a = 3; a <= 10; a++) {
+		glEnableVertexAttribArray(a);
+		glVertexAttribDivisor(a, 1);
+	}
+	pointObjectAttributes(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glBindVertexArray(0);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void RenderQueue::
+pointObjectAttributes(size_t object)
+//============================================================================
+{
+	size_t base = object * sizeof(Object);
+	for (int c = 0; c < 4; c++)
+		glVertexAttribPointer(3 + c, 4, GL_FLOAT, GL_FALSE, sizeof(Object),
+							  (void*)(base + offsetof(Object, model) + c * 4 * sizeof(float)));
+	for (int c = 0; c < 3; c++)
+		glVertexAttribPointer(7 + c, 3, GL_FLOAT, GL_FALSE, sizeof(Object),
+							  (void*)(base + offsetof(Object, normalMatrix) + c * 3 * sizeof(float)));
+	glVertexAttribPointer(10, 2, GL_FLOAT, GL_FALSE, sizeof(Object), (void*)(base + offsetof(Object, diffuse)));
+}
+
+//****************************************************************************
+//
+// * The objects and the commands go to the card in one piece each. Then
+//   every run is a draw call, with whatever has to change bound before
+//   it. What is bound is remembered from run to run; nothing is assumed
+//   about what was bound before the flush
+//============================================================================
+void RenderQueue::
+flush(const GeometryPool& pool)
+//============================================================================
+{
+	memset(&counters, 0, sizeof(counters));
+	counters.items = (unsigned int)items.size();
+	for (size_t i = 0; i < items.size(); i++)
+		counters.triangles += items[i].command.count / 3;
+	counters.culledItems = culledItems;
+	counters.culledTriangles = culledTriangles;
+	culledItems = culledTriangles = 0;
+	counters.objects = (unsigned int)objects.size();
+	// the draw functions did a Use() per object, and bound a vertex array,
+	// drew and bound 0 per mesh
+	counters.unsortedPrograms = counters.objects;
+	counters.unsortedVertexArrays = 2 * counters.items;
+	counters.unsortedDrawCalls = counters.items;
+	if (items.empty() || !pool.built()) {
+		items.clear();
+		objects.clear();
+		shaders.clear();
+		return;
+	}
+	if (!vao)
+		makeVertexArray(pool);
+
+	std::stable_sort(items.begin(), items.end(), drawsBefore);
+
+	commands.resize(items.size());
+	for (size_t i = 0; i < items.size(); i++)
+		commands[i] = items[i].command;
+
+	// new storage every flush, so the card can still be reading the last.
+	// Without base instances the object buffer stays bound, the object
+	// attributes are pointed into it item by item
+	glBindBuffer(GL_ARRAY_BUFFER, objectBuffer);
+	glBufferData(GL_ARRAY_BUFFER, objects.size() * sizeof(Object), &objects[0], GL_STREAM_DRAW);
+	if (drawMode == DRAW_INDIRECT) {
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(Command), &commands[0], GL_STREAM_DRAW);
+	}
+
+	glBindVertexArray(vao);
+	counters.vertexArrays++;
+	size_t pointedAt = 0;
+
+	int pass = -1;
+	GLuint program = 0;
+	GLuint bound[MAX_TEXTURES] = { 0 };
+	int activeUnit = -1;
+	int sampler = -1;
+	for (size_t first = 0; first < items.size();) {
+		const Item& item = items[first];
+		size_t last = first + 1;
+		while (last < items.size() && sameRun(item, items[last]))
+			last++;
+
+		if (item.pass != pass) {
+			pass = item.pass;
+			if (pass == PASS_SOLID)
+				glDisable(GL_BLEND);
+			else
+				glEnable(GL_BLEND);
+			glDepthMask(pass == PASS_BLEND_NO_DEPTH ? GL_FALSE : GL_TRUE);
+		}
+
+		if (item.program != program) {
+			program = item.program;
+			item.shader->Use();
+			counters.programs++;
+			// u_texture belongs to the program that was in use
+			sampler = -1;
+		}
+
+		for (size_t i = first; i < last; i++)
+			for (int t = 0; t < MAX_TEXTURES; t++)
+				if (items[i].textures[t])
+					counters.unsortedTextures++;
+		for (int t = 0; t < MAX_TEXTURES; t++) {
+			if (!item.textures[t] || item.textures[t] == bound[t])
+				continue;
+			if (t != activeUnit) {
+				glActiveTexture(GL_TEXTURE0 + t);
+				activeUnit = t;
+			}
+			glBindTexture(GL_TEXTURE_2D, item.textures[t]);
+			bound[t] = item.textures[t];
+			counters.textures++;
+		}
+
+		if (item.sampler != sampler) {
+			item.shader->setInt(Shader::TEXTURE, item.sampler);
+			sampler = item.sampler;
+		}
+
+		if (drawMode == DRAW_INDIRECT) {
+			glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(first * sizeof(Command)),
+										(GLsizei)(last - first), 0);
+			counters.drawCalls++;
+		}
+		else {
+			for (size_t i = first; i < last; i++) {
+				const Command& c = commands[i];
+				void* indices = (void*)(c.firstIndex * sizeof(GLuint));
+				if (drawMode == DRAW_BASE_INSTANCE)
+					glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, c.count, GL_UNSIGNED_INT, indices,
+																  1, c.baseVertex, c.baseInstance);
+				else {
+					if (c.baseInstance != pointedAt) {
+						pointObjectAttributes(c.baseInstance);
+						pointedAt = c.baseInstance;
+					}
+					glDrawElementsBaseVertex(GL_TRIANGLES, c.count, GL_UNSIGNED_INT, indices, c.baseVertex);
+				}
+				counters.drawCalls++;
+			}
+		}
+		first = last;
+	}
+
+	if (pass > PASS_SOLID) {
+		glDisable(GL_BLEND);
+		glDepthMask(GL_TRUE);
+	}
+	if (pointedAt != 0)
+		pointObjectAttributes(0);
+	if (drawMode == DRAW_INDIRECT)
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+	glActiveTexture(GL_TEXTURE0);
+	glUseProgram(0);
+
+	items.clear();
+	objects.clear();
+	shaders.clear();
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+const RenderQueue::Counters& RenderQueue::
+lastCounters() const
+//============================================================================
+{
+	return counters;
+}
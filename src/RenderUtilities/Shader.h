@@ -8,6 +8,8 @@
 #include <sstream>
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <cstring>
 
 
 
@@ -26,6 +28,30 @@ public:
 	//DEFINE_ENUM_FLAG_OPERATORS(Type);
 
 	Type type = NULL_SHADER;
+
+	// uniforms nearly every program here has. They are found in the table
+	// once, after linking, and are -1 if a program doesn't use one
+	enum Uniform {
+		MODEL,
+		COLOR,
+		TEXTURE,			// u_texture
+		NORMAL_MATRIX,		// normalMatrix
+		DIFFUSE_STRENGTH,	// of the light, for the lit shaders
+		SPECULAR_STRENGTH,
+		COMMON_UNIFORMS
+	};
+	GLint common[COMMON_UNIFORMS];
+
+	// the camera and the light are not uniforms of a program but the
+	// std140 block Frame, bound to this point in every program that has it
+	// (see TrainView::setUBO)
+	enum { FRAME_BINDING = 0 };
+
+	// texture_diffuse1 .. and texture_specular1 .., as Mesh::Draw numbers them
+	enum { MAX_MESH_TEXTURES = 4 };
+	GLint diffuseMaps[MAX_MESH_TEXTURES];
+	GLint specularMaps[MAX_MESH_TEXTURES];
+
 	// Constructor generates the shader on the fly
 	Shader(const GLchar* vert, const GLchar* tesc, const GLchar* tese, const char* geom, const char* frag)
 	{
@@ -74,13 +100,106 @@ public:
 
 		for (GLuint shader : shaders)
 			glDeleteShader(shader);
+
+		this->reflectUniforms();
 	}
 	// Uses the current shader
 	void Use()
 	{
 		glUseProgram(this->Program);
 	}
+
+	// Location of an active uniform by name (arrays without the [0]), or -1.
+	// A search of the table, not a call to GL - but still a search: look a
+	// uniform up once and keep the location, don't do it every frame
+	GLint uniform(const char* name) const
+	{
+		locationQueries()++;
+		std::vector<UniformEntry>::const_iterator found = std::lower_bound(
+			this->uniforms.begin(), this->uniforms.end(), name,
+			[](const UniformEntry& entry, const char* key) { return strcmp(entry.name.c_str(), key) < 0; });
+		if (found == this->uniforms.end() || found->name != name)
+			return -1;
+		return found->location;
+	}
+
+	// Typed setters for a location from uniform() or for one of the common
+	// uniforms. The program has to be in use; location -1 is ignored, as GL
+	// does
+	void setInt(GLint location, GLint value) { glUniform1i(location, value); }
+	void setInt(Uniform u, GLint value) { glUniform1i(this->common[u], value); }
+	void setUint(GLint location, GLuint value) { glUniform1ui(location, value); }
+	void setFloat(GLint location, GLfloat value) { glUniform1f(location, value); }
+	void setFloat(Uniform u, GLfloat value) { glUniform1f(this->common[u], value); }
+	void setVec3(GLint location, GLfloat x, GLfloat y, GLfloat z) { glUniform3f(location, x, y, z); }
+	void setVec3(Uniform u, GLfloat x, GLfloat y, GLfloat z) { glUniform3f(this->common[u], x, y, z); }
+	void setMat3(GLint location, const GLfloat* matrix) { glUniformMatrix3fv(location, 1, GL_FALSE, matrix); }
+	void setMat3(Uniform u, const GLfloat* matrix) { glUniformMatrix3fv(this->common[u], 1, GL_FALSE, matrix); }
+	void setMat4(GLint location, const GLfloat* matrix, GLsizei count = 1)
+	{
+		glUniformMatrix4fv(location, count, GL_FALSE, matrix);
+	}
+	void setMat4(Uniform u, const GLfloat* matrix) { glUniformMatrix4fv(this->common[u], 1, GL_FALSE, matrix); }
+
+	// Uniforms looked up by name so far - by uniform() and by GL when a
+	// program is linked - in all of the programs
+	static unsigned int& locationQueries()
+	{
+		static unsigned int queries = 0;
+		return queries;
+	}
 private:
+	struct UniformEntry
+	{
+		std::string name;
+		GLint location;
+	};
+	// active uniforms of the program, sorted by name
+	std::vector<UniformEntry> uniforms;
+
+	// ask GL for every active uniform once, right after linking, and find
+	// the common ones in the table
+	void reflectUniforms()
+	{
+		GLint count = 0;
+		glGetProgramiv(this->Program, GL_ACTIVE_UNIFORMS, &count);
+		for (GLint i = 0; i < count; i++)
+		{
+			GLchar name[256];
+			GLsizei length = 0;
+			GLint size;
+			GLenum kind;
+			glGetActiveUniform(this->Program, (GLuint)i, sizeof(name), &length, &size, &kind, name);
+			UniformEntry entry;
+			entry.name.assign(name, length);
+			if (entry.name.size() > 3 && entry.name.compare(entry.name.size() - 3, 3, "[0]") == 0)
+				entry.name.resize(entry.name.size() - 3);
+			entry.location = glGetUniformLocation(this->Program, name);
+			locationQueries()++;
+			// uniforms in blocks have no location of their own
+			if (entry.location >= 0)
+				this->uniforms.push_back(entry);
+		}
+		std::sort(this->uniforms.begin(), this->uniforms.end(),
+			[](const UniformEntry& a, const UniformEntry& b) { return a.name < b.name; });
+
+		const char* names[COMMON_UNIFORMS] = {
+			"model", "color", "u_texture", "normalMatrix", "diffuseStrength", "specularStrength"
+		};
+		for (int u = 0; u < COMMON_UNIFORMS; u++)
+			this->common[u] = this->uniform(names[u]);
+		for (int t = 0; t < MAX_MESH_TEXTURES; t++)
+		{
+			std::string number = std::to_string(t + 1);
+			this->diffuseMaps[t] = this->uniform(("texture_diffuse" + number).c_str());
+			this->specularMaps[t] = this->uniform(("texture_specular" + number).c_str());
+		}
+
+		GLuint frame = glGetUniformBlockIndex(this->Program, "Frame");
+		if (frame != GL_INVALID_INDEX)
+			glUniformBlockBinding(this->Program, frame, FRAME_BINDING);
+	}
+
 	std::string readCode(const GLchar* path)
 	{
 		std::string code;
@@ -55,6 +55,7 @@ public:
 		glActiveTexture(GL_TEXTURE0 + bind_unit);
 		glBindTexture(GL_TEXTURE_2D, 0);
 	}
+	GLuint getId() const { return this->id; }
 	glm::ivec2 size;
 private:
 	GLuint id;
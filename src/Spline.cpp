@@ -0,0 +1,237 @@
+/************************************************************************
+     File:        Spline.cpp
+
+     Comment:     Evaluating the track splines
+
+						See Spline.H
+
+     Platform:    Visio Studio.Net 2003/2005
+
+*************************************************************************/
+
+#include <math.h>
+
+#include "Spline.H"
+
+//****************************************************************************
+//
+// * Q(t) - pick the kernel for the type and evaluate once
+//============================================================================
+Pnt3f GMT(const Pnt3f p0, const Pnt3f p1, const Pnt3f p2, const Pnt3f p3, const int type, const float t)
+//============================================================================
+{
+	switch (type) {
+		case SPLINE_CARDINAL:	return splinePoint<SPLINE_CARDINAL>(p0, p1, p2, p3, t);
+		case SPLINE_BSPLINE:	return splinePoint<SPLINE_BSPLINE>(p0, p1, p2, p3, t);
+		default:				return splinePoint<SPLINE_LINEAR>(p0, p1, p2, p3, t);
+	}
+}
+
+//****************************************************************************
+//
+// * Q'(t)
+//============================================================================
+Pnt3f GMTTangent(const Pnt3f p0, const Pnt3f p1, const Pnt3f p2, const Pnt3f p3, const int type, const float t)
+//============================================================================
+{
+	switch (type) {
+		case SPLINE_CARDINAL:	return splineTangent<SPLINE_CARDINAL>(p0, p1, p2, p3, t);
+		case SPLINE_BSPLINE:	return splineTangent<SPLINE_BSPLINE>(p0, p1, p2, p3, t);
+		default:				return splineTangent<SPLINE_LINEAR>(p0, p1, p2, p3, t);
+	}
+}
+
+//****************************************************************************
+//
+// * Q''(t)
+//============================================================================
+Pnt3f GMTSecondDerivative(const Pnt3f p0, const Pnt3f p1, const Pnt3f p2, const Pnt3f p3, const int type, const float t)
+//============================================================================
+{
+	switch (type) {
+		case SPLINE_CARDINAL:	return splineSecondDerivative<SPLINE_CARDINAL>(p0, p1, p2, p3, t);
+		case SPLINE_BSPLINE:	return splineSecondDerivative<SPLINE_BSPLINE>(p0, p1, p2, p3, t);
+		default:				return splineSecondDerivative<SPLINE_LINEAR>(p0, p1, p2, p3, t);
+	}
+}
+
+//****************************************************************************
+//
+// * One segment, many t. The control points are loop invariant, so the body
+//   is the same few multiply-adds for every t
+//============================================================================
+template <int TYPE>
+static void batchSegment(const Pnt3f& p0, const Pnt3f& p1, const Pnt3f& p2, const Pnt3f& p3,
+						 const float* ts, size_t count, float* x, float* y, float* z)
+//============================================================================
+{
+	for (size_t k = 0; k < count; ++k) {
+		float w[4];
+		splineWeights<TYPE>(ts[k], w);
+		x[k] = w[0] * p0.x + w[1] * p1.x + w[2] * p2.x + w[3] * p3.x;
+		y[k] = w[0] * p0.y + w[1] * p1.y + w[2] * p2.y + w[3] * p3.y;
+		z[k] = w[0] * p0.z + w[1] * p1.z + w[2] * p2.z + w[3] * p3.z;
+	}
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void GMTBatch(const Pnt3f p0, const Pnt3f p1, const Pnt3f p2, const Pnt3f p3, const int type,
+			  const float* ts, size_t count, float* x, float* y, float* z)
+//============================================================================
+{
+	switch (type) {
+		case SPLINE_CARDINAL:	batchSegment<SPLINE_CARDINAL>(p0, p1, p2, p3, ts, count, x, y, z); break;
+		case SPLINE_BSPLINE:	batchSegment<SPLINE_BSPLINE>(p0, p1, p2, p3, ts, count, x, y, z); break;
+		default:				batchSegment<SPLINE_LINEAR>(p0, p1, p2, p3, ts, count, x, y, z); break;
+	}
+}
+
+//****************************************************************************
+//
+// * Many segments, one t each
+//============================================================================
+template <int TYPE>
+static void batchTrack(const vector<ControlPoint>& points, bool orient,
+					   const int* segments, const float* ts, size_t count, float* x, float* y, float* z)
+//============================================================================
+{
+	size_t n = points.size();
+	for (size_t k = 0; k < count; ++k) {
+		size_t i = (size_t)segments[k];
+		const ControlPoint& c0 = points[i % n];
+		const ControlPoint& c1 = points[(i + 1) % n];
+		const ControlPoint& c2 = points[(i + 2) % n];
+		const ControlPoint& c3 = points[(i + 3) % n];
+		const Pnt3f& p0 = orient ? c0.orient : c0.pos;
+		const Pnt3f& p1 = orient ? c1.orient : c1.pos;
+		const Pnt3f& p2 = orient ? c2.orient : c2.pos;
+		const Pnt3f& p3 = orient ? c3.orient : c3.pos;
+
+		float w[4];
+		splineWeights<TYPE>(ts[k], w);
+		x[k] = w[0] * p0.x + w[1] * p1.x + w[2] * p2.x + w[3] * p3.x;
+		y[k] = w[0] * p0.y + w[1] * p1.y + w[2] * p2.y + w[3] * p3.y;
+		z[k] = w[0] * p0.z + w[1] * p1.z + w[2] * p2.z + w[3] * p3.z;
+	}
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void GMTBatch(const vector<ControlPoint>& points, const int type, bool orient,
+			  const int* segments, const float* ts, size_t count, float* x, float* y, float* z)
+//============================================================================
+{
+	if (points.empty())
+		return;
+	switch (type) {
+		case SPLINE_CARDINAL:	batchTrack<SPLINE_CARDINAL>(points, orient, segments, ts, count, x, y, z); break;
+		case SPLINE_BSPLINE:	batchTrack<SPLINE_BSPLINE>(points, orient, segments, ts, count, x, y, z); break;
+		default:				batchTrack<SPLINE_LINEAR>(points, orient, segments, ts, count, x, y, z); break;
+	}
+}
+
+//****************************************************************************
+//
+// * |Q'(t)|
+//============================================================================
+template <int TYPE>
+static double speedAt(const Pnt3f& p0, const Pnt3f& p1, const Pnt3f& p2, const Pnt3f& p3, double t)
+//============================================================================
+{
+	Pnt3f d = splineTangent<TYPE>(p0, p1, p2, p3, (float)t);
+	return sqrt((double)d.x * d.x + (double)d.y * d.y + (double)d.z * d.z);
+}
+
+//****************************************************************************
+//
+// * 5 point Gauss-Legendre rule for the integral of |Q'| over [t0, t1]
+//============================================================================
+template <int TYPE>
+static double gaussLength(const Pnt3f& p0, const Pnt3f& p1, const Pnt3f& p2, const Pnt3f& p3,
+						  double t0, double t1)
+//============================================================================
+{
+	static const double x[5] = {
+		0.0, -0.5384693101056831, 0.5384693101056831, -0.9061798459386640, 0.9061798459386640
+	};
+	static const double w[5] = {
+		0.5688888888888889, 0.4786286704993665, 0.4786286704993665, 0.2369268850561891, 0.2369268850561891
+	};
+
+	double half = 0.5 * (t1 - t0);
+	double mid = 0.5 * (t1 + t0);
+	double sum = 0;
+	for (int k = 0; k < 5; ++k)
+		sum += w[k] * speedAt<TYPE>(p0, p1, p2, p3, mid + half * x[k]);
+	return sum * half;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+double GMTArcLength(const Pnt3f p0, const Pnt3f p1, const Pnt3f p2, const Pnt3f p3, const int type,
+					const float t0, const float t1)
+//============================================================================
+{
+	switch (type) {
+		case SPLINE_CARDINAL:	return gaussLength<SPLINE_CARDINAL>(p0, p1, p2, p3, t0, t1);
+		case SPLINE_BSPLINE:	return gaussLength<SPLINE_BSPLINE>(p0, p1, p2, p3, t0, t1);
+		default:				return gaussLength<SPLINE_LINEAR>(p0, p1, p2, p3, t0, t1);
+	}
+}
+
+//****************************************************************************
+//
+// * Newton on f(t) = length(t0, t) - length, f'(t) = |Q'(t)|. The guess
+//   starts as if the speed were constant, and a step that leaves the
+//   bracket falls back to bisection
+//============================================================================
+template <int TYPE>
+static float parameterAtLength(const Pnt3f& p0, const Pnt3f& p1, const Pnt3f& p2, const Pnt3f& p3,
+							   const float t0, const float t1, const double length, int* iterations)
+//============================================================================
+{
+	double total = gaussLength<TYPE>(p0, p1, p2, p3, t0, t1);
+	int steps = 0;
+	if (total <= 0 || length <= 0 || length >= total) {
+		if (iterations) *iterations = 0;
+		return (length <= 0 || total <= 0) ? t0 : t1;
+	}
+
+	double lo = t0, hi = t1;
+	double t = t0 + (t1 - t0) * (length / total);
+	const double tolerance = 1e-7 * total;
+	for (steps = 0; steps < 8; ++steps) {
+		double f = gaussLength<TYPE>(p0, p1, p2, p3, t0, t) - length;
+		if (fabs(f) < tolerance)
+			break;
+		if (f > 0) hi = t; else lo = t;
+
+		double speed = speedAt<TYPE>(p0, p1, p2, p3, t);
+		double next = (speed > 0) ? t - f / speed : lo - 1;
+		t = (next > lo && next < hi) ? next : 0.5 * (lo + hi);
+	}
+	if (iterations) *iterations = steps;
+	return (float)t;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+float GMTParameterAtLength(const Pnt3f p0, const Pnt3f p1, const Pnt3f p2, const Pnt3f p3, const int type,
+						   const float t0, const float t1, const double length, int* iterations)
+//============================================================================
+{
+	switch (type) {
+		case SPLINE_CARDINAL:	return parameterAtLength<SPLINE_CARDINAL>(p0, p1, p2, p3, t0, t1, length, iterations);
+		case SPLINE_BSPLINE:	return parameterAtLength<SPLINE_BSPLINE>(p0, p1, p2, p3, t0, t1, length, iterations);
+		default:				return parameterAtLength<SPLINE_LINEAR>(p0, p1, p2, p3, t0, t1, length, iterations);
+	}
+}
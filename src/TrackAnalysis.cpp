@@ -0,0 +1,136 @@
+/************************************************************************
+     File:        TrackAnalysis.cpp
+
+     Comment:     Numbers that say whether a track is any good
+
+						See TrackAnalysis.H
+
+     Platform:    Visio Studio.Net 2003/2005
+
+*************************************************************************/
+
+#include <math.h>
+
+#include "TrackAnalysis.H"
+#include "TrackMesh.H"
+#include "Spline.H"
+
+//****************************************************************************
+//
+// *
+//============================================================================
+static float dot(const Pnt3f& a, const Pnt3f& b)
+//============================================================================
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+//****************************************************************************
+//
+// * The part of Q'' square to the heading, over |Q'|^2, is the curvature
+//   times the unit normal - how fast the heading turns per unit of length
+//============================================================================
+static Pnt3f bendAt(const vector<ControlPoint>& points, int splineType, int segment, float t,
+					Pnt3f& heading)
+//============================================================================
+{
+	size_t n = points.size();
+	const Pnt3f& p0 = points[segment % n].pos;
+	const Pnt3f& p1 = points[(segment + 1) % n].pos;
+	const Pnt3f& p2 = points[(segment + 2) % n].pos;
+	const Pnt3f& p3 = points[(segment + 3) % n].pos;
+
+	heading = GMTTangent(p0, p1, p2, p3, splineType, t);
+	Pnt3f acc = GMTSecondDerivative(p0, p1, p2, p3, splineType, t);
+	float speed2 = dot(heading, heading);
+	if (speed2 <= 0)
+		return Pnt3f(0, 0, 0);
+
+	Pnt3f across = acc - heading * (dot(heading, acc) / speed2);
+	return across * (1.0f / speed2);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void analyzeTrack(const vector<ControlPoint>& points, int splineType, const TrainPhysics& physics,
+				  double maxTime, TrackReport& report)
+//============================================================================
+{
+	report.points = points.size();
+	report.length = report.maxSlope = report.maxCurvature = 0;
+	report.minVerticalG = report.maxVerticalG = report.maxLateralG = 0;
+	report.minSpeed = report.maxSpeed = 0;
+	report.lapTime = -1;
+
+	TrackMesh mesh;
+	mesh.update(points, splineType);
+	const ArcLengthIndex& arc = mesh.arcLength;
+	report.length = arc.totalLength();
+	if (report.length <= 0)
+		return;
+
+	// the shape
+	for (size_t k = 0; k < arc.sampleCount(); k++) {
+		int segment;
+		float t0, t1;
+		arc.getSample(k, segment, t0, t1);
+		for (int half = 0; half < 2; half++) {
+			Pnt3f heading;
+			Pnt3f bend = bendAt(points, splineType, segment, half ? 0.5f * (t0 + t1) : t0, heading);
+			double curvature = bend.getLength();
+			if (curvature > report.maxCurvature)
+				report.maxCurvature = curvature;
+			double along = heading.getLength();
+			if (along > 0) {
+				double slope = asin(fabs(heading.y) / along) * 180 / 3.14159265358979;
+				if (slope > report.maxSlope)
+					report.maxSlope = slope;
+			}
+		}
+	}
+
+	// the ride
+	TrainPhysics ride = physics;
+	ride.reset(0, (ride.liftSpeed > 0) ? ride.liftSpeed : 0);
+	report.minSpeed = report.maxSpeed = ride.speed;
+	report.minVerticalG = 1e30;
+	report.maxVerticalG = -1e30;
+	double travelled = 0, time = 0;
+	while (time < maxTime) {
+		double before = ride.position;
+		ride.step(arc);
+		time += ride.timeStep;
+
+		double moved = ride.position - before;
+		if (moved > report.length / 2) moved -= report.length;
+		if (moved < -report.length / 2) moved += report.length;
+		travelled += moved;
+
+		double v = ride.speed;
+		if (v < report.minSpeed) report.minSpeed = v;
+		if (v > report.maxSpeed) report.maxSpeed = v;
+
+		int segment;
+		float t;
+		TrackFrame frame;
+		if (mesh.locate(points, ride.position, segment, t) && arc.frameAt(ride.position, frame)) {
+			Pnt3f heading;
+			Pnt3f felt = bendAt(points, splineType, segment, t, heading) * (float)(v * v) +
+						 Pnt3f(0, (float)ride.gravity, 0);
+			double vertical = dot(felt, frame.up) / ride.gravity;
+			double lateral = fabs(dot(felt, frame.side)) / ride.gravity;
+			if (vertical < report.minVerticalG) report.minVerticalG = vertical;
+			if (vertical > report.maxVerticalG) report.maxVerticalG = vertical;
+			if (lateral > report.maxLateralG) report.maxLateralG = lateral;
+		}
+
+		if (travelled >= report.length) {
+			report.lapTime = time;
+			break;
+		}
+	}
+	if (report.minVerticalG > report.maxVerticalG)
+		report.minVerticalG = report.maxVerticalG = 0;
+}
@@ -0,0 +1,202 @@
+/************************************************************************
+     File:        TrackAnalysisMain.cpp
+
+     Comment:     Command line tool that checks a pile of track files
+
+						TrackAnalysis [options] file-or-directory ...
+
+							--spline 1|2|3	spline type, like the "Spline
+											Type" browser (default 2,
+											cardinal)
+							--lift speed	chain lift speed (default 60,
+											the app with the speed slider
+											at 2); 0 for a free ride
+							--time seconds	give up on a lap after this
+											long (default 600)
+							--threads n		how many files at once
+											(default: one per core)
+
+						A directory stands for every .txt and .trk file in
+						it. The files are spread over the threads, and the
+						answer comes out as comma separated values, one
+						line per file in the order they were given, under
+						a header line. A file that can't be read gets its error in
+						the status column and zeros for the rest.
+
+						This links the track, spline, arc-length and
+						physics code only - no FLTK and no OpenGL - so it
+						is built with TRACK_HEADLESS defined.
+
+     Platform:    Visio Studio.Net 2003/2005
+
+*************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#include "TrackFile.H"
+#include "TrackAnalysis.H"
+
+using std::string;
+using std::vector;
+
+//****************************************************************************
+//
+// * Text or binary
+//============================================================================
+static bool isTrackFileName(const string& name)
+//============================================================================
+{
+	return name.size() > 4 && (name.compare(name.size() - 4, 4, ".txt") == 0 ||
+							   name.compare(name.size() - 4, 4, ".trk") == 0);
+}
+
+//****************************************************************************
+//
+// * The track files in dir, sorted by name. Returns false if dir is not a
+//   directory
+//============================================================================
+static bool listTrackFiles(const string& dir, vector<string>& files)
+//============================================================================
+{
+	vector<string> names;
+#ifdef _WIN32
+	struct _finddata_t found;
+	intptr_t handle = _findfirst((dir + "\\*.*").c_str(), &found);
+	if (handle == -1) {
+		struct _finddata_t self;
+		intptr_t h = _findfirst(dir.c_str(), &self);
+		if (h == -1)
+			return false;
+		_findclose(h);
+		if (!(self.attrib & _A_SUBDIR))
+			return false;
+	}
+	else {
+		do {
+			string name = found.name;
+			if (!(found.attrib & _A_SUBDIR) && isTrackFileName(name))
+				names.push_back(name);
+		} while (_findnext(handle, &found) == 0);
+		_findclose(handle);
+	}
+#else
+	DIR* d = opendir(dir.c_str());
+	if (!d)
+		return false;
+	while (struct dirent* entry = readdir(d)) {
+		string name = entry->d_name;
+		struct stat info;
+		if (isTrackFileName(name) && stat((dir + "/" + name).c_str(), &info) == 0 && S_ISREG(info.st_mode))
+			names.push_back(name);
+	}
+	closedir(d);
+#endif
+	std::sort(names.begin(), names.end());
+	for (size_t k = 0; k < names.size(); k++)
+		files.push_back(dir + "/" + names[k]);
+	return true;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+static void usage()
+//============================================================================
+{
+	fprintf(stderr, "usage: TrackAnalysis [--spline 1|2|3] [--lift speed] [--time seconds] "
+					"[--threads n] file-or-directory ...\n");
+}
+
+//****************************************************************************
+//
+// * Read the options, list the files, then let every thread take the next
+//   file that nobody has taken yet
+//============================================================================
+int main(int argc, char** argv)
+//============================================================================
+{
+	int splineType = 2;
+	double maxTime = 600;
+	unsigned int threads = std::thread::hardware_concurrency();
+	TrainPhysics physics;
+
+	vector<string> files;
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--spline" && hasValue)
+			splineType = atoi(argv[++i]);
+		else if (arg == "--lift" && hasValue)
+			physics.liftSpeed = atof(argv[++i]);
+		else if (arg == "--time" && hasValue)
+			maxTime = atof(argv[++i]);
+		else if (arg == "--threads" && hasValue)
+			threads = (unsigned int)atoi(argv[++i]);
+		else if (arg.size() > 1 && arg[0] == '-') {
+			usage();
+			return 2;
+		}
+		else if (!listTrackFiles(arg, files))
+			files.push_back(arg);
+	}
+	if (files.empty()) {
+		usage();
+		return 2;
+	}
+	if (threads < 1)
+		threads = 1;
+	if (threads > files.size())
+		threads = (unsigned int)files.size();
+
+	vector<TrackReport> reports(files.size());
+	vector<const char*> errors(files.size(), (const char*)0);
+	std::atomic<size_t> next(0);
+	vector<std::thread> workers;
+	for (unsigned int w = 0; w < threads; w++)
+		workers.push_back(std::thread([&]() {
+			for (size_t k = next++; k < files.size(); k = next++) {
+				vector<ControlPoint> points;
+				if (readTrackFile(files[k].c_str(), points, 0, &errors[k]))
+					analyzeTrack(points, splineType, physics, maxTime, reports[k]);
+				else
+					memset(&reports[k], 0, sizeof(TrackReport));
+			}
+		}));
+	for (size_t w = 0; w < workers.size(); w++)
+		workers[w].join();
+
+	int failed = 0;
+	printf("file,status,points,length,max_slope_deg,max_curvature,min_vertical_g,max_vertical_g,"
+		   "max_lateral_g,min_speed,max_speed,lap_time\n");
+	for (size_t k = 0; k < files.size(); k++) {
+		const TrackReport& r = reports[k];
+		string status = "ok";
+		if (errors[k]) {
+			status = errors[k];
+			status.erase(std::remove(status.begin(), status.end(), '\n'), status.end());
+			std::replace(status.begin(), status.end(), ',', ';');
+			failed++;
+		}
+		else if (r.lapTime < 0)
+			status = "stalled";
+		printf("%s,%s,%u,%.3f,%.3f,%.6f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+			   files[k].c_str(), status.c_str(), (unsigned)r.points, r.length, r.maxSlope, r.maxCurvature,
+			   r.minVerticalG, r.maxVerticalG, r.maxLateralG, r.minSpeed, r.maxSpeed, r.lapTime);
+	}
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,330 @@
+/************************************************************************
+     File:        TrackClearance.cpp
+
+     Comment:     Does the train hit anything in the park?
+
+						See TrackClearance.H
+
+     Platform:    Visio Studio.Net 2003/2005
+
+*************************************************************************/
+
+#include <math.h>
+#include <algorithm>
+#include <thread>
+
+#include "TrackClearance.H"
+#include "TrainCars.H"
+
+//****************************************************************************
+//
+// * Constructor
+//============================================================================
+TriangleBVH::
+TriangleBVH()
+//============================================================================
+{
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void TriangleBVH::
+clear()
+//============================================================================
+{
+	triangles.clear();
+	owners.clear();
+	tree.clear();
+}
+
+//****************************************************************************
+//
+// * The tree is out of date until build() is called again
+//============================================================================
+void TriangleBVH::
+addTriangles(const float* vertices, size_t stride, const unsigned int* indices, size_t indexCount,
+			 const float* matrix, int owner)
+//============================================================================
+{
+	const unsigned char* bytes = (const unsigned char*)vertices;
+	for (size_t i = 0; i + 2 < indexCount; i += 3) {
+		for (int c = 0; c < 3; c++) {
+			const float* v = (const float*)(bytes + indices[i + c] * stride);
+			for (int r = 0; r < 3; r++)
+				triangles.push_back(matrix ? matrix[r] * v[0] + matrix[4 + r] * v[1] + matrix[8 + r] * v[2] +
+											 matrix[12 + r]
+										   : v[r]);
+		}
+		owners.push_back(owner);
+	}
+	tree.clear();
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void TriangleBVH::
+build()
+//============================================================================
+{
+	size_t count = triangleCount();
+	vector<float> boxes(count * 6);
+	for (size_t t = 0; t < count; t++) {
+		const float* v = &triangles[t * 9];
+		for (int r = 0; r < 3; r++) {
+			boxes[t * 6 + r] = std::min(v[r], std::min(v[3 + r], v[6 + r]));
+			boxes[t * 6 + 3 + r] = std::max(v[r], std::max(v[3 + r], v[6 + r]));
+		}
+	}
+	tree.build(boxes);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+size_t TriangleBVH::
+triangleCount() const
+//============================================================================
+{
+	return triangles.size() / 9;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+size_t TriangleBVH::
+nodeCount() const
+//============================================================================
+{
+	return tree.nodeCount();
+}
+
+//****************************************************************************
+//
+// * Separating axis test of a triangle against the box centered at the
+//   origin with the half sizes h along x, y and z: the 3 axes of the box,
+//   the normal of the triangle and the 9 crosses of an edge with an axis
+//============================================================================
+static bool triangleHitsBox(const float v[3][3], const float h[3])
+//============================================================================
+{
+	for (int r = 0; r < 3; r++) {
+		float lo = std::min(v[0][r], std::min(v[1][r], v[2][r]));
+		float hi = std::max(v[0][r], std::max(v[1][r], v[2][r]));
+		if (lo > h[r] || hi < -h[r])
+			return false;
+	}
+
+	float e[3][3];
+	for (int r = 0; r < 3; r++) {
+		e[0][r] = v[1][r] - v[0][r];
+		e[1][r] = v[2][r] - v[1][r];
+		e[2][r] = v[0][r] - v[2][r];
+	}
+
+	float n[3] = { e[0][1] * e[1][2] - e[0][2] * e[1][1],
+				   e[0][2] * e[1][0] - e[0][0] * e[1][2],
+				   e[0][0] * e[1][1] - e[0][1] * e[1][0] };
+	float d = n[0] * v[0][0] + n[1] * v[0][1] + n[2] * v[0][2];
+	if (fabsf(d) > h[0] * fabsf(n[0]) + h[1] * fabsf(n[1]) + h[2] * fabsf(n[2]))
+		return false;
+
+	for (int i = 0; i < 3; i++)
+		for (int a = 0; a < 3; a++) {
+			// the axis a x e[i]
+			int b = (a + 1) % 3, c = (a + 2) % 3;
+			float axis[3];
+			axis[a] = 0;
+			axis[b] = -e[i][c];
+			axis[c] = e[i][b];
+
+			float p0 = axis[0] * v[0][0] + axis[1] * v[0][1] + axis[2] * v[0][2];
+			float p1 = axis[0] * v[1][0] + axis[1] * v[1][1] + axis[2] * v[1][2];
+			float p2 = axis[0] * v[2][0] + axis[1] * v[2][1] + axis[2] * v[2][2];
+			float radius = h[0] * fabsf(axis[0]) + h[1] * fabsf(axis[1]) + h[2] * fabsf(axis[2]);
+			if (std::min(p0, std::min(p1, p2)) > radius || std::max(p0, std::max(p1, p2)) < -radius)
+				return false;
+		}
+	return true;
+}
+
+//****************************************************************************
+//
+// * Down the tree with the world box around the turned box, then each
+//   triangle that is left is moved into the space of the box and tested
+//============================================================================
+bool TriangleBVH::
+overlapsBox(const Pnt3f& center, const Pnt3f axes[3], const float half[3]) const
+//============================================================================
+{
+	float c[3] = { center.x, center.y, center.z };
+	float lo[3], hi[3];
+	for (int r = 0; r < 3; r++) {
+		float reach = 0;
+		for (int k = 0; k < 3; k++) {
+			const float* axis = &axes[k].x;
+			reach += fabsf(axis[r]) * half[k];
+		}
+		lo[r] = c[r] - reach;
+		hi[r] = c[r] + reach;
+	}
+
+	return tree.overlapping(lo, hi, [&](uint32_t triangle) {
+		const float* t = &triangles[triangle * 9];
+		float local[3][3];
+		for (int v = 0; v < 3; v++) {
+			float d[3] = { t[v * 3] - c[0], t[v * 3 + 1] - c[1], t[v * 3 + 2] - c[2] };
+			for (int a = 0; a < 3; a++)
+				local[v][a] = d[0] * axes[a].x + d[1] * axes[a].y + d[2] * axes[a].z;
+		}
+		return triangleHitsBox(local, half);
+	});
+}
+
+//****************************************************************************
+//
+// * Moller-Trumbore on every triangle the tree hands over. Both sides of
+//   a triangle count
+//============================================================================
+bool TriangleBVH::
+raycast(const Pnt3f& origin, const Pnt3f& dir, float maxDistance, float& distance, int& owner) const
+//============================================================================
+{
+	float o[3] = { origin.x, origin.y, origin.z };
+	float d[3] = { dir.x, dir.y, dir.z };
+	float nearest = maxDistance;
+	int found = -1;
+
+	tree.raycast(o, d, nearest, [&](uint32_t triangle, float& best) {
+		const float* t = &triangles[triangle * 9];
+		float e1[3], e2[3], s[3];
+		for (int r = 0; r < 3; r++) {
+			e1[r] = t[3 + r] - t[r];
+			e2[r] = t[6 + r] - t[r];
+			s[r] = o[r] - t[r];
+		}
+		float p[3] = { d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0] };
+		float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+		if (fabsf(det) < 1e-12f)
+			return;
+		float inv = 1.0f / det;
+		float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inv;
+		if (u < 0 || u > 1)
+			return;
+		float q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+		float v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * inv;
+		if (v < 0 || u + v > 1)
+			return;
+		float along = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * inv;
+		if (along >= 0 && along < best) {
+			best = along;
+			found = (int)triangle;
+		}
+	});
+
+	if (found < 0)
+		return false;
+	distance = nearest;
+	owner = owners[found];
+	return true;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+ClearanceEnvelope trainEnvelope(float margin)
+//============================================================================
+{
+	ClearanceEnvelope envelope;
+	trainCrossSection(envelope.halfWidth, envelope.bottom, envelope.top);
+	envelope.margin = margin;
+	return envelope;
+}
+
+//****************************************************************************
+//
+// * Steps first .. first + count - 1 of the walk: hit[k] says whether
+//   step k runs into anything
+//============================================================================
+static void checkSteps(const TriangleBVH& bvh, const ArcLengthIndex& track, const ClearanceEnvelope& envelope,
+					   double step, size_t first, size_t count, char* hit)
+//============================================================================
+{
+	const size_t batch = 256;
+	TrackFrame frames[batch];
+	float half[3] = { envelope.halfWidth + envelope.margin, (float)(step / 2) + envelope.margin,
+					  (envelope.top - envelope.bottom) / 2 + envelope.margin };
+	float lift = (envelope.top + envelope.bottom) / 2;
+
+	for (size_t k = 0; k < count; k += batch) {
+		size_t n = std::min(batch, count - k);
+		track.framesAlong((first + k + 0.5) * step, step, n, frames);
+		for (size_t i = 0; i < n; i++) {
+			const TrackFrame& f = frames[i];
+			Pnt3f axes[3] = { f.side, f.forward, f.up };
+			hit[first + k + i] = bvh.overlapsBox(f.pos + f.up * lift, axes, half) ? 1 : 0;
+		}
+	}
+}
+
+//****************************************************************************
+//
+// * The steps are cut into one run per thread. step is stretched a little
+//   so a whole number of them fits on the track
+//============================================================================
+void checkClearance(const TriangleBVH& bvh, const ArcLengthIndex& track, const ClearanceEnvelope& envelope,
+					double step, unsigned int threads, vector<ClearanceHit>& hits)
+//============================================================================
+{
+	hits.clear();
+	double length = track.totalLength();
+	if (length <= 0 || step <= 0 || !bvh.triangleCount())
+		return;
+
+	size_t count = (size_t)ceil(length / step);
+	step = length / count;
+	vector<char> hit(count, 0);
+
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	if (threads > count)
+		threads = (unsigned int)count;
+
+	if (threads == 1)
+		checkSteps(bvh, track, envelope, step, 0, count, &hit[0]);
+	else {
+		vector<std::thread> workers;
+		for (unsigned int w = 0; w < threads; w++) {
+			size_t first = count * w / threads;
+			size_t last = count * (w + 1) / threads;
+			workers.push_back(std::thread(checkSteps, std::cref(bvh), std::cref(track), std::cref(envelope),
+										  step, first, last - first, &hit[0]));
+		}
+		for (size_t w = 0; w < workers.size(); w++)
+			workers[w].join();
+	}
+
+	for (size_t k = 0; k < count; k++) {
+		if (!hit[k])
+			continue;
+		size_t end = k;
+		while (end + 1 < count && hit[end + 1])
+			end++;
+		ClearanceHit range = { k * step, (end + 1) * step };
+		hits.push_back(range);
+		k = end;
+	}
+
+	// the track is a loop: a hit over the start is one range, from the
+	// last one on past the end of the track
+	if (hits.size() > 1 && hit[0] && hit[count - 1]) {
+		hits.back().end = length + hits[0].end;
+		hits.erase(hits.begin());
+	}
+}
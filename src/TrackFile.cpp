@@ -0,0 +1,602 @@
+/************************************************************************
+     File:        TrackFile.cpp
+
+     Comment:     Reading and writing track files
+
+						See TrackFile.H
+
+     Platform:    Visio Studio.Net 2003/2005
+
+*************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "TrackFile.H"
+
+//****************************************************************************
+//
+// * Handy utility to break a string into a list of words
+//============================================================================
+static void breakString(char* str, std::vector<const char*>& words)
+//============================================================================
+{
+	// start with no words
+	words.clear();
+
+	// scan through the string, starting at the beginning
+	char* p = str;
+
+	// stop when we hit the end of the string
+	while(*p) {
+		// skip over leading whitespace - stop at the first character or end of string
+		while (*p && *p<=' ') p++;
+
+		// now we're pointing at the first thing after the spaces
+		// make sure its not a comment, and that we're not at the end of the string
+		// (that's actually the same thing)
+		if (! (*p) || *p == '#')
+		break;
+
+		// so we're pointing at a word! add it to the word list
+		words.push_back(p);
+
+		// now find the end of the word
+		while(*p > ' ') p++;	// stop at space or end of string
+
+		// if its ethe end of the string, we're done
+		if (! *p) break;
+
+		// otherwise, turn this space into and end of string (to end the word)
+		// and keep going
+		*p = 0;
+		p++;
+	}
+}
+
+//****************************************************************************
+//
+// * Get lines until EOF or we have enough points
+//============================================================================
+bool readTrackText(const char* filename, vector<ControlPoint>& points, const char** error)
+//============================================================================
+{
+	FILE* fp = fopen(filename,"r");
+	if (!fp) {
+		if (error) *error = "Can't Open File!\n";
+		return false;
+	}
+
+	char buf[512];
+
+	// first line = number of points
+	if (!fgets(buf,512,fp))
+		buf[0] = 0;
+	size_t npts = (size_t) atoi(buf);
+
+	if( (npts<4) || (npts>65535)) {
+		fclose(fp);
+		if (error) *error = "Illegal Number of Points Specified in File";
+		return false;
+	}
+
+	points.clear();
+	while( (points.size() < npts) && fgets(buf,512,fp) ) {
+		Pnt3f pos,orient;
+		vector<const char*> words;
+		breakString(buf,words);
+		if (words.size() >= 3) {
+			pos.x = (float) strtod(words[0],0);
+			pos.y = (float) strtod(words[1],0);
+			pos.z = (float) strtod(words[2],0);
+		} else {
+			pos.x=0;
+			pos.y=0;
+			pos.z=0;
+		}
+		if (words.size() >= 6) {
+			orient.x = (float) strtod(words[3],0);
+			orient.y = (float) strtod(words[4],0);
+			orient.z = (float) strtod(words[5],0);
+		} else {
+			orient.x = 0;
+			orient.y = 1;
+			orient.z = 0;
+		}
+		// one that is unit length already is kept as it is, so that a
+		// file we wrote reads back to the same floats
+		float length2 = orient.x * orient.x + orient.y * orient.y + orient.z * orient.z;
+		if (fabs(length2 - 1.0f) > 1e-6f)
+			orient.normalize();
+		ControlPoint point(pos);
+		point.orient = orient;
+		points.push_back(point);
+	}
+	fclose(fp);
+	return true;
+}
+
+//****************************************************************************
+//
+// * 9 digits, so that reading it back gives the same floats
+//============================================================================
+bool writeTrackText(const char* filename, const vector<ControlPoint>& points, const char** error)
+//============================================================================
+{
+	FILE* fp = fopen(filename,"w");
+	if (!fp) {
+		if (error) *error = "Can't open file for writing";
+		return false;
+	}
+
+	fprintf(fp,"%d\n",(int)points.size());
+	for(size_t i=0; i<points.size(); ++i)
+		fprintf(fp,"%.9g %.9g %.9g %.9g %.9g %.9g\n",
+			points[i].pos.x, points[i].pos.y, points[i].pos.z,
+			points[i].orient.x, points[i].orient.y, points[i].orient.z);
+	fclose(fp);
+	return true;
+}
+
+//****************************************************************************
+//
+// * Constructor
+//============================================================================
+TrackFileView::
+TrackFileView()
+	: data(0), size(0), file(0), mapping(0)
+//============================================================================
+{
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+TrackFileView::
+~TrackFileView()
+//============================================================================
+{
+	close();
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void TrackFileView::
+close()
+//============================================================================
+{
+#ifdef _WIN32
+	if (data) UnmapViewOfFile(data);
+	if (mapping) CloseHandle((HANDLE)mapping);
+	if (file) CloseHandle((HANDLE)file);
+#else
+	if (data) munmap((void*)data, size);
+#endif
+	data = 0;
+	size = 0;
+	file = mapping = 0;
+}
+
+//****************************************************************************
+//
+// * Map the whole file read only, then check that everything the header
+//   points at is inside of it
+//============================================================================
+bool TrackFileView::
+open(const char* filename, const char** error)
+//============================================================================
+{
+	close();
+
+#ifdef _WIN32
+	HANDLE f = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (f == INVALID_HANDLE_VALUE) {
+		if (error) *error = "Can't Open File!\n";
+		return false;
+	}
+	file = f;
+	LARGE_INTEGER length;
+	if (GetFileSizeEx(f, &length) && length.QuadPart >= (LONGLONG)sizeof(TrackFileHeader)) {
+		mapping = CreateFileMappingA(f, 0, PAGE_READONLY, 0, 0, 0);
+		if (mapping) {
+			data = (const unsigned char*)MapViewOfFile((HANDLE)mapping, FILE_MAP_READ, 0, 0, 0);
+			size = (size_t)length.QuadPart;
+		}
+	}
+#else
+	int fd = ::open(filename, O_RDONLY);
+	if (fd < 0) {
+		if (error) *error = "Can't Open File!\n";
+		return false;
+	}
+	struct stat info;
+	if (fstat(fd, &info) == 0 && info.st_size >= (off_t)sizeof(TrackFileHeader)) {
+		void* p = mmap(0, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p != MAP_FAILED) {
+			data = (const unsigned char*)p;
+			size = (size_t)info.st_size;
+		}
+	}
+	::close(fd);
+#endif
+
+	if (!data) {
+		close();
+		if (error) *error = "Not a Track File";
+		return false;
+	}
+
+	const TrackFileHeader& h = header();
+	if (h.magic != TRACK_FILE_MAGIC) {
+		close();
+		if (error) *error = "Not a Track File";
+		return false;
+	}
+	if (h.version != TRACK_FILE_VERSION) {
+		close();
+		if (error) *error = "Track File is From Another Version";
+		return false;
+	}
+
+	// every array has to fit, and start on 8 bytes
+	struct { uint64_t offset; uint64_t bytes; } arrays[] = {
+		{ h.positions, 12ull * h.pointCount },
+		{ h.orients, 12ull * h.pointCount },
+		{ h.prefix, 8ull * (h.pieceCount + 1ull) },
+		{ h.pieceSegments, 4ull * h.pieceCount },
+		{ h.pieceT0, 4ull * h.pieceCount },
+		{ h.pieceT1, 4ull * h.pieceCount },
+		{ h.frames, 48ull * h.pieceCount },
+		{ h.railVertices, 12ull * h.railVertexCount },
+		{ h.segmentVertices, 4ull * h.segmentCount }
+	};
+	bool fits = h.fileSize == size && h.pointCount >= 4 && h.positions && h.orients;
+	for (size_t k = 0; fits && k < sizeof(arrays) / sizeof(arrays[0]); k++) {
+		if (arrays[k].offset == 0)
+			continue;
+		fits = arrays[k].offset % 8 == 0 && arrays[k].offset >= sizeof(TrackFileHeader) &&
+			   arrays[k].offset <= size && arrays[k].bytes <= size - arrays[k].offset;
+	}
+	if (h.splineType > 0)
+		fits = fits && h.prefix && h.pieceSegments && h.pieceT0 && h.pieceT1 && h.frames &&
+			   h.railVertices && h.segmentVertices && h.segmentCount == h.pointCount;
+
+	// the lookups in ArcLengthIndex and TrackMesh trust the tables, so
+	// they have to be in order and point inside of the arrays: every
+	// segment has pieces, in order, the distances never go back, and the
+	// rail vertices of each segment are inside of the rail array
+	if (fits && h.splineType > 0 && h.pieceCount) {
+		const double* prefix = (const double*)at(h.prefix);
+		const int32_t* segments = (const int32_t*)at(h.pieceSegments);
+		const uint32_t* vertices = (const uint32_t*)at(h.segmentVertices);
+		fits = prefix[0] == 0 && segments[0] == 0 && segments[h.pieceCount - 1] == (int32_t)h.segmentCount - 1;
+		for (uint32_t k = 0; fits && k < h.pieceCount; k++)
+			fits = prefix[k + 1] >= prefix[k] &&
+				   (k == 0 || segments[k] == segments[k - 1] || segments[k] == segments[k - 1] + 1);
+		for (uint32_t i = 0; fits && i < h.segmentCount; i++)
+			fits = vertices[i] <= h.railVertexCount && (i == 0 || vertices[i] >= vertices[i - 1]);
+	}
+	if (!fits) {
+		close();
+		if (error) *error = "Track File is Damaged";
+		return false;
+	}
+	return true;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+const TrackFileHeader& TrackFileView::
+header() const
+//============================================================================
+{
+	return *(const TrackFileHeader*)data;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+bool TrackFileView::
+hasMesh() const
+//============================================================================
+{
+	return data && header().splineType > 0;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+const void* TrackFileView::
+at(uint64_t offset) const
+//============================================================================
+{
+	return (data && offset) ? data + offset : 0;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+const float* TrackFileView::
+positions() const
+//============================================================================
+{
+	return (const float*)at(header().positions);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+const float* TrackFileView::
+orients() const
+//============================================================================
+{
+	return (const float*)at(header().orients);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+const double* TrackFileView::
+prefix() const
+//============================================================================
+{
+	return (const double*)at(header().prefix);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+const int32_t* TrackFileView::
+pieceSegments() const
+//============================================================================
+{
+	return (const int32_t*)at(header().pieceSegments);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+const float* TrackFileView::
+pieceT0() const
+//============================================================================
+{
+	return (const float*)at(header().pieceT0);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+const float* TrackFileView::
+pieceT1() const
+//============================================================================
+{
+	return (const float*)at(header().pieceT1);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+const float* TrackFileView::
+frames() const
+//============================================================================
+{
+	return (const float*)at(header().frames);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+const float* TrackFileView::
+railVertices() const
+//============================================================================
+{
+	return (const float*)at(header().railVertices);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+const uint32_t* TrackFileView::
+segmentVertices() const
+//============================================================================
+{
+	return (const uint32_t*)at(header().segmentVertices);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+bool isBinaryTrackFile(const char* filename)
+//============================================================================
+{
+	FILE* fp = fopen(filename, "rb");
+	if (!fp)
+		return false;
+	uint32_t magic = 0;
+	bool binary = fread(&magic, sizeof(magic), 1, fp) == 1 && magic == TRACK_FILE_MAGIC;
+	fclose(fp);
+	return binary;
+}
+
+//****************************************************************************
+//
+// * The points are copied out of the mapping, and so are the tables -
+//   straight into the mesh, with no spline to sample
+//============================================================================
+bool readTrackBinary(const char* filename, vector<ControlPoint>& points, TrackMesh* mesh, const char** error)
+//============================================================================
+{
+	TrackFileView view;
+	if (!view.open(filename, error))
+		return false;
+
+	const TrackFileHeader& h = view.header();
+	const float* pos = view.positions();
+	const float* ori = view.orients();
+	points.resize(h.pointCount);
+	for (size_t i = 0; i < h.pointCount; i++) {
+		points[i].pos = Pnt3f(pos + 3 * i);
+		points[i].orient = Pnt3f(ori + 3 * i);
+	}
+
+	if (!mesh)
+		return true;
+	if (!view.hasMesh()) {
+		mesh->markDirty();
+		return true;
+	}
+
+	static_assert(sizeof(TrackFrame) == 12 * sizeof(float), "TrackFrame has to be 12 floats");
+	static_assert(sizeof(Pnt3f) == 3 * sizeof(float), "Pnt3f has to be 3 floats");
+	vector<TrackFrame> frames(h.pieceCount);
+	if (h.pieceCount)
+		memcpy(static_cast<void*>(&frames[0]), view.frames(), sizeof(TrackFrame) * h.pieceCount);
+	mesh->arcLength.setTables(h.pieceCount, view.prefix(), view.pieceSegments(), view.pieceT0(),
+							  view.pieceT1(), h.pieceCount ? &frames[0] : 0);
+	mesh->railVertices.resize(h.railVertexCount);
+	if (h.railVertexCount)
+		memcpy(static_cast<void*>(&mesh->railVertices[0]), view.railVertices(), sizeof(Pnt3f) * h.railVertexCount);
+	vector<size_t> vertexFirst(view.segmentVertices(), view.segmentVertices() + h.segmentCount);
+	mesh->adopt(points, h.splineType, vertexFirst);
+	return true;
+}
+
+//****************************************************************************
+//
+// * Lay the arrays out one after the other, then write the header and the
+//   arrays in that order
+//============================================================================
+bool writeTrackBinary(const char* filename, const vector<ControlPoint>& points, const TrackMesh* mesh,
+					  const char** error)
+//============================================================================
+{
+	TrackFileHeader h;
+	memset(&h, 0, sizeof(h));
+	h.magic = TRACK_FILE_MAGIC;
+	h.version = TRACK_FILE_VERSION;
+	h.pointCount = (uint32_t)points.size();
+
+	const double* prefix = 0;
+	const int* segments = 0;
+	const float* t0 = 0;
+	const float* t1 = 0;
+	const TrackFrame* frames = 0;
+	vector<uint32_t> vertexFirst;
+	bool withMesh = mesh && mesh->getSplineType() > 0 && mesh->isCurrent(points);
+	if (withMesh) {
+		mesh->arcLength.getTables(prefix, segments, t0, t1, frames);
+		h.splineType = mesh->getSplineType();
+		h.pieceCount = (uint32_t)mesh->arcLength.sampleCount();
+		h.segmentCount = h.pointCount;
+		h.railVertexCount = (uint32_t)mesh->railVertices.size();
+		vertexFirst.resize(h.segmentCount);
+		for (size_t i = 0; i < h.segmentCount; i++) {
+			size_t first, count;
+			mesh->getSegmentVertices(i, first, count);
+			vertexFirst[i] = (uint32_t)first;
+		}
+	}
+
+	uint64_t end = (sizeof(TrackFileHeader) + 7) & ~7ull;
+	uint64_t* offsets[] = { &h.positions, &h.orients, &h.prefix, &h.pieceSegments, &h.pieceT0, &h.pieceT1,
+							&h.frames, &h.railVertices, &h.segmentVertices };
+	uint64_t bytes[] = { 12ull * h.pointCount, 12ull * h.pointCount, 8ull * (h.pieceCount + 1ull),
+						 4ull * h.pieceCount, 4ull * h.pieceCount, 4ull * h.pieceCount, 48ull * h.pieceCount,
+						 12ull * h.railVertexCount, 4ull * h.segmentCount };
+	size_t arrays = withMesh ? 9 : 2;
+	for (size_t k = 0; k < arrays; k++) {
+		*offsets[k] = end;
+		end = (end + bytes[k] + 7) & ~7ull;
+	}
+	h.fileSize = end;
+
+	vector<float> pos(3 * points.size()), ori(3 * points.size());
+	for (size_t i = 0; i < points.size(); i++) {
+		memcpy(&pos[3 * i], &points[i].pos, sizeof(Pnt3f));
+		memcpy(&ori[3 * i], &points[i].orient, sizeof(Pnt3f));
+	}
+	const void* contents[] = { pos.empty() ? 0 : &pos[0], ori.empty() ? 0 : &ori[0], prefix, segments, t0, t1,
+							   frames, withMesh && h.railVertexCount ? &mesh->railVertices[0] : 0,
+							   vertexFirst.empty() ? 0 : &vertexFirst[0] };
+
+	FILE* fp = fopen(filename, "wb");
+	if (!fp) {
+		if (error) *error = "Can't open file for writing";
+		return false;
+	}
+	static const char zeros[8] = { 0 };
+	bool ok = fwrite(&h, sizeof(h), 1, fp) == 1;
+	uint64_t written = sizeof(h);
+	for (size_t k = 0; ok && k < arrays; k++) {
+		if (written < *offsets[k])
+			ok = fwrite(zeros, 1, (size_t)(*offsets[k] - written), fp) == *offsets[k] - written;
+		if (ok && bytes[k])
+			ok = fwrite(contents[k], 1, (size_t)bytes[k], fp) == bytes[k];
+		written = *offsets[k] + bytes[k];
+	}
+	if (ok && written < end)
+		ok = fwrite(zeros, 1, (size_t)(end - written), fp) == end - written;
+	if (fclose(fp) != 0)
+		ok = false;
+	if (!ok && error)
+		*error = "Can't write the whole file";
+	return ok;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+bool readTrackFile(const char* filename, vector<ControlPoint>& points, TrackMesh* mesh, const char** error)
+//============================================================================
+{
+	if (isBinaryTrackFile(filename))
+		return readTrackBinary(filename, points, mesh, error);
+	if (!readTrackText(filename, points, error))
+		return false;
+	if (mesh)
+		mesh->markDirty();
+	return true;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+bool writeTrackFile(const char* filename, const vector<ControlPoint>& points, const TrackMesh* mesh,
+					const char** error)
+//============================================================================
+{
+	size_t length = strlen(filename);
+	if (length > 4 && strcmp(filename + length - 4, ".trk") == 0)
+		return writeTrackBinary(filename, points, mesh, error);
+	return writeTrackText(filename, points, error);
+}
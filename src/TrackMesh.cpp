@@ -0,0 +1,684 @@
+/************************************************************************
+     File:        TrackMesh.cpp
+
+     Comment:     Cached geometry of the track
+
+						See TrackMesh.H
+
+     Platform:    Visio Studio.Net 2003/2005
+
+*************************************************************************/
+
+#include <math.h>
+#include <algorithm>
+
+#include "TrackMesh.H"
+#include "Spline.H"
+
+//****************************************************************************
+//
+// * Constructor
+//============================================================================
+TrackMesh::
+TrackMesh() 
+	: tileSpacing(7.5f), supportSpacing(40.0f), floorHeight(0.0f), chunkLength(200.0f), railWidth(2.5f),
+	  chordTolerance(0.11f), maxAngle(0.25f), minPieces(2), maxPieces(256),
+	  dirty(true), builtSplineType(-1), builtPointCount(0), version(0), fullRebuild(true)
+//============================================================================
+{
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void TrackMesh::
+markDirty()
+//============================================================================
+{
+	dirty = true;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void TrackMesh::
+markPointDirty(size_t index)
+//============================================================================
+{
+	dirtyPoints.push_back(index);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+unsigned int TrackMesh::
+getVersion() const
+//============================================================================
+{
+	return version;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+int TrackMesh::
+getSplineType() const
+//============================================================================
+{
+	return builtSplineType;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+bool TrackMesh::
+isCurrent(const vector<ControlPoint>& points) const
+//============================================================================
+{
+	return !dirty && dirtyPoints.empty() && points.size() == builtPointCount;
+}
+
+//****************************************************************************
+//
+// * Everything but the sampling: the tiles and chunks are cheap to make
+//   from the tables
+//============================================================================
+bool TrackMesh::
+adopt(const vector<ControlPoint>& points, int splineType, const vector<size_t>& vertexFirst)
+//============================================================================
+{
+	size_t n = points.size();
+	bool fits = n > 0 && vertexFirst.size() == n && arcLength.segmentStart((int)n - 1) < arcLength.totalLength() &&
+				arcLength.segmentStart((int)n) == arcLength.totalLength();
+	for (size_t i = 0; fits && i < n; i++)
+		fits = vertexFirst[i] <= railVertices.size() && (i == 0 || vertexFirst[i] >= vertexFirst[i - 1]);
+	if (!fits) {
+		arcLength.clear();
+		railVertices.clear();
+		dirty = true;
+		return false;
+	}
+
+	segmentVertexFirst = vertexFirst;
+	changedSegments.clear();
+	fullRebuild = true;
+	buildTiles(0);
+	buildSupports(0);
+	buildChunks(true);
+
+	dirty = false;
+	dirtyPoints.clear();
+	builtSplineType = splineType;
+	builtPointCount = n;
+	version++;
+	return true;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+bool TrackMesh::
+wasFullRebuild() const
+//============================================================================
+{
+	return fullRebuild;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+const vector<size_t>& TrackMesh::
+getChangedSegments() const
+//============================================================================
+{
+	return changedSegments;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void TrackMesh::
+getSegmentVertices(size_t segment, size_t& first, size_t& count) const
+//============================================================================
+{
+	first = segmentVertexFirst[segment];
+	size_t end = (segment + 1 < segmentVertexFirst.size()) ? segmentVertexFirst[segment + 1] : railVertices.size();
+	count = end - first;
+}
+
+//****************************************************************************
+//
+// * The sleepers and the pillars are laid out from half of their spacing
+//   in, see buildTiles()
+//============================================================================
+int TrackMesh::
+getTileSegment(size_t tile) const
+//============================================================================
+{
+	int segment = 0;
+	float t;
+	arcLength.locate(tileSpacing * (tile + 0.5), segment, t);
+	return segment;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+int TrackMesh::
+getSupportSegment(size_t support) const
+//============================================================================
+{
+	int segment = 0;
+	float t;
+	arcLength.locate(supportSpacing * (support + 0.5), segment, t);
+	return segment;
+}
+
+//****************************************************************************
+//
+// * The table finds the piece, Newton finds t inside of it
+//============================================================================
+bool TrackMesh::
+locate(const vector<ControlPoint>& points, double s, int& segment, float& t) const
+//============================================================================
+{
+	size_t piece;
+	double offset;
+	size_t n = points.size();
+	if (!arcLength.locatePiece(s, piece, offset) || n != builtPointCount) {
+		segment = 0;
+		t = 0;
+		return false;
+	}
+
+	float t0, t1;
+	arcLength.getSample(piece, segment, t0, t1);
+	t = GMTParameterAtLength(points[segment % n].pos, points[(segment + 1) % n].pos,
+							 points[(segment + 2) % n].pos, points[(segment + 3) % n].pos,
+							 builtSplineType, t0, t1, offset);
+	return true;
+}
+
+//****************************************************************************
+//
+// * Only do the work if something changed since the last time. When just a
+//   few points moved, resample the segments that use them and leave the
+//   rest of the track alone
+//============================================================================
+bool TrackMesh::
+update(const vector<ControlPoint>& points, int splineType)
+//============================================================================
+{
+	size_t n = points.size();
+	bool same = splineType == builtSplineType && n == builtPointCount;
+	if (!dirty && dirtyPoints.empty() && same)
+		return false;
+
+	vector<Pnt3f> verts;
+	vector<double> lengths;
+	vector<float> ts;
+	vector<TrackFrame> frames;
+	changedSegments.clear();
+
+	// a moved point changes segments index-3 .. index
+	if (!dirty && same) {
+		for (size_t k = 0; k < dirtyPoints.size(); ++k)
+			for (size_t d = 0; d < 4; ++d)
+				changedSegments.push_back((dirtyPoints[k] % n + n - d) % n);
+		std::sort(changedSegments.begin(), changedSegments.end());
+		changedSegments.erase(std::unique(changedSegments.begin(), changedSegments.end()),
+							  changedSegments.end());
+	}
+
+	// patching is only worth it if most of the track stays put
+	fullRebuild = changedSegments.empty() || changedSegments.size() * 2 > n;
+	bool resampledAll = fullRebuild;
+	if (fullRebuild) {
+		changedSegments.clear();
+		arcLength.clear();
+		railVertices.clear();
+		segmentVertexFirst.resize(n);
+		for (size_t i = 0; i < n; i++) {
+			sampleSegment(points, splineType, i, verts, lengths, ts, frames);
+			segmentVertexFirst[i] = railVertices.size();
+			railVertices.insert(railVertices.end(), verts.begin(), verts.end());
+			for (size_t j = 0; j < lengths.size(); j++)
+				arcLength.addSample(lengths[j], (int)i, ts[j], ts[j + 1], frames[j]);
+		}
+	}
+	else {
+		for (size_t k = 0; k < changedSegments.size(); ++k) {
+			size_t seg = changedSegments[k];
+			sampleSegment(points, splineType, seg, verts, lengths, ts, frames);
+			arcLength.replaceSegment((int)seg, lengths, ts, frames);
+
+			size_t first, count;
+			getSegmentVertices(seg, first, count);
+			if (count == verts.size()) {
+				std::copy(verts.begin(), verts.end(), railVertices.begin() + first);
+			}
+			else {
+				// the segment got more or fewer pieces - everything after
+				// it moves, so the whole buffer has to go again
+				railVertices.erase(railVertices.begin() + first, railVertices.begin() + first + count);
+				railVertices.insert(railVertices.begin() + first, verts.begin(), verts.end());
+				for (size_t i = seg + 1; i < n; i++)
+					segmentVertexFirst[i] = segmentVertexFirst[i] + verts.size() - count;
+				fullRebuild = true;
+			}
+		}
+	}
+
+	// a sleeper at the end of the segment before a changed one is blended
+	// with the changed one's first frame, so start a segment early
+	double tilesFrom = 0;
+	if (!resampledAll && changedSegments.front() > 0)
+		tilesFrom = arcLength.segmentStart((int)changedSegments.front() - 1);
+	buildTiles(tilesFrom);
+	buildSupports(tilesFrom);
+	buildChunks(resampledAll);
+
+	dirty = false;
+	dirtyPoints.clear();
+	builtSplineType = splineType;
+	builtPointCount = n;
+	version++;
+	return true;
+}
+
+//****************************************************************************
+//
+// * A sleeper sticks out 1.5 rail widths on each side, and is 2 units long
+//   and 2 thick. It hangs one unit under the rails
+//============================================================================
+void TrackMesh::
+buildTiles(double from)
+//============================================================================
+{
+	double total = arcLength.totalLength();
+	if (tileSpacing <= 0 || total < tileSpacing * 0.5) {
+		tileTransforms.clear();
+		return;
+	}
+
+	size_t count = (size_t)((total - tileSpacing * 0.5) / tileSpacing) + 1;
+	size_t first = (size_t)ceil(from / tileSpacing - 0.5);
+	if (first > count || first * 16 > tileTransforms.size())
+		first = 0;
+	tileTransforms.resize(count * 16);
+	if (first == count)
+		return;
+
+	vector<TrackFrame> frames(count - first);
+	arcLength.framesAlong(tileSpacing * (first + 0.5), tileSpacing, count - first, &frames[0]);
+
+	float across = 1.5f * railWidth;
+	for (size_t k = first; k < count; k++) {
+		const TrackFrame& f = frames[k - first];
+		Pnt3f x = f.side * across;
+		Pnt3f center = f.pos - f.up;
+		float m[16] = {
+			x.x,			x.y,			x.z,			0,
+			f.forward.x,	f.forward.y,	f.forward.z,	0,
+			f.up.x,			f.up.y,			f.up.z,			0,
+			center.x,		center.y,		center.z,		1
+		};
+		std::copy(m, m + 16, tileTransforms.begin() + k * 16);
+	}
+}
+
+//****************************************************************************
+//
+// * A pillar is 2 units under the rails (below the sleeper) at the middle
+//   of the track. It is left out (height 0) where that is less than 2
+//   units over the floor
+//============================================================================
+void TrackMesh::
+buildSupports(double from)
+//============================================================================
+{
+	double total = arcLength.totalLength();
+	if (supportSpacing <= 0 || total < supportSpacing * 0.5) {
+		supportInstances.clear();
+		return;
+	}
+
+	size_t count = (size_t)((total - supportSpacing * 0.5) / supportSpacing) + 1;
+	size_t first = (size_t)ceil(from / supportSpacing - 0.5);
+	if (first > count || first * 4 > supportInstances.size())
+		first = 0;
+	supportInstances.resize(count * 4);
+	if (first == count)
+		return;
+
+	vector<TrackFrame> frames(count - first);
+	arcLength.framesAlong(supportSpacing * (first + 0.5), supportSpacing, count - first, &frames[0]);
+
+	for (size_t k = first; k < count; k++) {
+		const TrackFrame& f = frames[k - first];
+		float top = f.pos.y - 2.0f;
+		float height = top - floorHeight;
+		float* out = &supportInstances[k * 4];
+		out[0] = f.pos.x;
+		out[1] = f.pos.z;
+		out[2] = top;
+		out[3] = (height >= 2.0f) ? height : 0.0f;
+	}
+}
+
+//****************************************************************************
+//
+// * The boxes only come from the rails - the sleepers stick out past them by
+//   less than margin, and a chunk with pillars reaches down to the floor.
+//   The ranges are cheap, so they are always redone
+//============================================================================
+void TrackMesh::
+buildChunks(bool regroup)
+//============================================================================
+{
+	size_t n = segmentVertexFirst.size();
+	vector<bool> stale;
+	if (regroup) {
+		chunks.clear();
+		segmentChunk.resize(n);
+		for (size_t i = 0; i < n; i++) {
+			double start = arcLength.segmentStart((int)i);
+			if (chunks.empty() ||
+				start - arcLength.segmentStart((int)chunks.back().firstSegment) >= chunkLength) {
+				TrackChunk c;
+				c.firstSegment = i;
+				c.segmentCount = 0;
+				chunks.push_back(c);
+			}
+			chunks.back().segmentCount++;
+			segmentChunk[i] = chunks.size() - 1;
+		}
+		stale.assign(chunks.size(), true);
+	}
+	else {
+		stale.assign(chunks.size(), false);
+		for (size_t k = 0; k < changedSegments.size(); k++)
+			stale[segmentChunk[changedSegments[k]]] = true;
+	}
+
+	size_t tiles = tileTransforms.size() / 16;
+	size_t supports = supportInstances.size() / 4;
+	float margin = 1.5f * railWidth + 2.0f;
+	for (size_t c = 0; c < chunks.size(); c++) {
+		TrackChunk& chunk = chunks[c];
+		size_t end = chunk.firstSegment + chunk.segmentCount;
+		chunk.firstVertex = segmentVertexFirst[chunk.firstSegment];
+		chunk.vertexCount = ((end < n) ? segmentVertexFirst[end] : railVertices.size()) - chunk.firstVertex;
+
+		// sleeper k is at (k + 0.5) * tileSpacing
+		double from = arcLength.segmentStart((int)chunk.firstSegment);
+		double to = arcLength.segmentStart((int)end);
+		size_t first = (size_t)ceil(from / tileSpacing - 0.5);
+		size_t last = (size_t)ceil(to / tileSpacing - 0.5);
+		if (first > tiles) first = tiles;
+		if (last > tiles || end >= n) last = tiles;
+		chunk.firstTile = first;
+		chunk.tileCount = last - first;
+
+		// and pillar k at (k + 0.5) * supportSpacing
+		first = (size_t)ceil(from / supportSpacing - 0.5);
+		last = (size_t)ceil(to / supportSpacing - 0.5);
+		if (first > supports) first = supports;
+		if (last > supports || end >= n) last = supports;
+		chunk.firstSupport = first;
+		chunk.supportCount = last - first;
+
+		if (!stale[c] || chunk.vertexCount == 0)
+			continue;
+		Pnt3f lo = railVertices[chunk.firstVertex];
+		Pnt3f hi = lo;
+		for (size_t v = chunk.firstVertex; v < chunk.firstVertex + chunk.vertexCount; v++) {
+			const Pnt3f& p = railVertices[v];
+			if (p.x < lo.x) lo.x = p.x;
+			if (p.y < lo.y) lo.y = p.y;
+			if (p.z < lo.z) lo.z = p.z;
+			if (p.x > hi.x) hi.x = p.x;
+			if (p.y > hi.y) hi.y = p.y;
+			if (p.z > hi.z) hi.z = p.z;
+		}
+		chunk.boxMin = lo - Pnt3f(margin, margin, margin);
+		chunk.boxMax = hi + Pnt3f(margin, margin, margin);
+		if (chunk.supportCount && chunk.boxMin.y > floorHeight)
+			chunk.boxMin.y = floorHeight;
+	}
+}
+
+//****************************************************************************
+//
+// * How long (in t) the piece starting at t may be. The curve drifts from
+//   the chord by about |Q''| dt^2 / 8, the heading turns by about
+//   |Q' x Q''| / |Q'|^2 dt and the banking by about |O'| / |O| dt
+//============================================================================
+template <int TYPE>
+static float pieceLength(const ControlPoint& p0, const ControlPoint& p1,
+						 const ControlPoint& p2, const ControlPoint& p3,
+						 float t, float dt, const TrackMesh& mesh)
+//============================================================================
+{
+	float end = (t + dt < 1) ? t + dt : 1;
+
+	// Q'' is linear in t, so the ends of the piece bound it
+	Pnt3f acc0 = splineSecondDerivative<TYPE>(p0.pos, p1.pos, p2.pos, p3.pos, t);
+	Pnt3f acc1 = splineSecondDerivative<TYPE>(p0.pos, p1.pos, p2.pos, p3.pos, end);
+	Pnt3f acc = (acc0.getLength() > acc1.getLength()) ? acc0 : acc1;
+	float bend = acc.getLength();
+
+	float limit = 1.0f / mesh.minPieces;
+	if (bend > 0) {
+		float sagLimit = sqrtf(8.0f * mesh.chordTolerance / bend);
+		if (sagLimit < limit) limit = sagLimit;
+	}
+
+	Pnt3f vel = splineTangent<TYPE>(p0.pos, p1.pos, p2.pos, p3.pos, t);
+	float speed2 = vel.x * vel.x + vel.y * vel.y + vel.z * vel.z;
+	if (speed2 > 0) {
+		float turn = (vel * acc).getLength() / speed2;
+		if (turn > 0 && mesh.maxAngle / turn < limit) limit = mesh.maxAngle / turn;
+	}
+
+	Pnt3f ori = splinePoint<TYPE>(p0.orient, p1.orient, p2.orient, p3.orient, t);
+	Pnt3f roll = splineTangent<TYPE>(p0.orient, p1.orient, p2.orient, p3.orient, t);
+	float oriLength = ori.getLength();
+	if (oriLength > 0) {
+		float rate = roll.getLength() / oriLength;
+		if (rate > 0 && mesh.maxAngle / rate < limit) limit = mesh.maxAngle / rate;
+	}
+
+	float shortest = 1.0f / mesh.maxPieces;
+	return (limit > shortest) ? limit : shortest;
+}
+
+//****************************************************************************
+//
+// * Walk along the segment one piece at a time
+//============================================================================
+template <int TYPE>
+static void tessellate(const ControlPoint& p0, const ControlPoint& p1,
+					   const ControlPoint& p2, const ControlPoint& p3,
+					   const TrackMesh& mesh, vector<float>& ts)
+//============================================================================
+{
+	ts.clear();
+	ts.push_back(0);
+	float t = 0;
+	float dt = 1.0f / mesh.minPieces;
+	for (;;) {
+		// guess with the last length, then check again over the new piece
+		dt = pieceLength<TYPE>(p0, p1, p2, p3, t, dt, mesh);
+		dt = pieceLength<TYPE>(p0, p1, p2, p3, t, dt, mesh);
+		if (1 - t <= dt)
+			break;
+		t += dt;
+		ts.push_back(t);
+	}
+	ts.push_back(1);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void TrackMesh::
+tessellateSegment(const vector<ControlPoint>& points, int splineType,
+				  size_t segment, vector<float>& ts) const
+//============================================================================
+{
+	size_t n = points.size();
+	const ControlPoint& p0 = points[segment % n];
+	const ControlPoint& p1 = points[(segment + 1) % n];
+	const ControlPoint& p2 = points[(segment + 2) % n];
+	const ControlPoint& p3 = points[(segment + 3) % n];
+
+	switch (splineType) {
+		case SPLINE_CARDINAL:	tessellate<SPLINE_CARDINAL>(p0, p1, p2, p3, *this, ts); break;
+		case SPLINE_BSPLINE:	tessellate<SPLINE_BSPLINE>(p0, p1, p2, p3, *this, ts); break;
+		default:				tessellate<SPLINE_LINEAR>(p0, p1, p2, p3, *this, ts); break;
+	}
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+static float dot(const Pnt3f& a, const Pnt3f& b)
+//============================================================================
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+//****************************************************************************
+//
+// * The orient at t, made square to the heading. If the orient points
+//   along the track there is nothing to go on, so pick any up
+//============================================================================
+static Pnt3f keyUp(const Pnt3f& forward, Pnt3f ori)
+//============================================================================
+{
+	Pnt3f up = ori - forward * dot(forward, ori);
+	if (up.getLength() < 1e-4f) {
+		Pnt3f axis = (fabs(forward.y) > 0.9f) ? Pnt3f(1, 0, 0) : Pnt3f(0, 1, 0);
+		up = axis - forward * dot(forward, axis);
+	}
+	up.normalize();
+	return up;
+}
+
+//****************************************************************************
+//
+// * Cut the segment where tessellateSegment says, and put a frame at every
+//   cut. Each piece gets the two rails plus the two lines under them
+//============================================================================
+void TrackMesh::
+sampleSegment(const vector<ControlPoint>& points, int splineType, size_t segment,
+			  vector<Pnt3f>& verts, vector<double>& lengths, vector<float>& ts,
+			  vector<TrackFrame>& frames) const
+//============================================================================
+{
+	size_t n = points.size();
+	const ControlPoint& p0 = points[segment % n];
+	const ControlPoint& p1 = points[(segment + 1) % n];
+	const ControlPoint& p2 = points[(segment + 2) % n];
+	const ControlPoint& p3 = points[(segment + 3) % n];
+
+	tessellateSegment(points, splineType, segment, ts);
+	size_t pieces = ts.size() - 1;
+	size_t count = ts.size();
+
+	verts.clear();
+	lengths.resize(pieces);
+	frames.resize(count);
+
+	// all of the positions in one batch
+	vector<float> qx(count), qy(count), qz(count);
+	GMTBatch(p0.pos, p1.pos, p2.pos, p3.pos, splineType, &ts[0], count, &qx[0], &qy[0], &qz[0]);
+
+	for (size_t j = 0; j < count; j++) {
+		TrackFrame& f = frames[j];
+		f.pos = Pnt3f(qx[j], qy[j], qz[j]);
+		f.forward = GMTTangent(p0.pos, p1.pos, p2.pos, p3.pos, splineType, ts[j]);
+		if (f.forward.getLength() < 1e-6f) {
+			// the curve stops for an instant - use the chord instead
+			f.forward = (j + 1 < count) ? Pnt3f(qx[j + 1], qy[j + 1], qz[j + 1]) - f.pos
+										: f.pos - Pnt3f(qx[j - 1], qy[j - 1], qz[j - 1]);
+		}
+		f.forward.normalize();
+	}
+	for (size_t j = 0; j < pieces; j++)
+		lengths[j] = GMTArcLength(p0.pos, p1.pos, p2.pos, p3.pos, splineType, ts[j], ts[j + 1]);
+
+	// carry the up vector from the start of the segment to its end. Each
+	// step reflects it across the plane between the two positions, then
+	// across the one between the reflected heading and the real one
+	frames[0].up = keyUp(frames[0].forward, GMT(p0.orient, p1.orient, p2.orient, p3.orient, splineType, 0));
+	for (size_t j = 0; j < pieces; j++) {
+		const TrackFrame& a = frames[j];
+		TrackFrame& b = frames[j + 1];
+		Pnt3f v1 = b.pos - a.pos;
+		float c1 = dot(v1, v1);
+		Pnt3f r = a.up;
+		Pnt3f tl = a.forward;
+		if (c1 > 0) {
+			r = r - v1 * (2 * dot(v1, r) / c1);
+			tl = tl - v1 * (2 * dot(v1, tl) / c1);
+		}
+		Pnt3f v2 = b.forward - tl;
+		float c2 = dot(v2, v2);
+		if (c2 > 0)
+			r = r - v2 * (2 * dot(v2, r) / c2);
+		b.up = keyUp(b.forward, r);
+	}
+
+	// then turn it a little more along the way, so that it arrives at the
+	// orient of the end of the segment
+	Pnt3f target = keyUp(frames[pieces].forward, GMT(p0.orient, p1.orient, p2.orient, p3.orient, splineType, 1));
+	const Pnt3f& arrived = frames[pieces].up;
+	float twist = atan2f(dot(frames[pieces].forward, arrived * target), dot(arrived, target));
+	double total = 0;
+	for (size_t j = 0; j < pieces; j++)
+		total += lengths[j];
+
+	double along = 0;
+	for (size_t j = 0; j < count; j++) {
+		TrackFrame& f = frames[j];
+		if (total > 0 && twist != 0) {
+			float angle = (float)(twist * along / total);
+			// Rodrigues, with up already square to the axis
+			f.up = f.up * cosf(angle) + (f.forward * f.up) * sinf(angle);
+		}
+		f.side = f.forward * f.up;
+		f.side.normalize();
+		f.up = f.side * f.forward;
+		if (j < pieces)
+			along += lengths[j];
+	}
+
+	for (size_t j = 0; j < pieces; j++) {
+		const TrackFrame& a = frames[j];
+		const TrackFrame& b = frames[j + 1];
+		Pnt3f sideA = a.side * railWidth, sideB = b.side * railWidth;
+		Pnt3f downA = a.up * railWidth, downB = b.up * railWidth;
+
+		verts.push_back(a.pos + sideA);
+		verts.push_back(b.pos + sideB);
+		verts.push_back(a.pos - sideA);
+		verts.push_back(b.pos - sideB);
+		verts.push_back(a.pos + sideA - downA);
+		verts.push_back(b.pos + sideB - downB);
+		verts.push_back(a.pos - sideA - downA);
+		verts.push_back(b.pos - sideB - downB);
+	}
+}
@@ -0,0 +1,246 @@
+/************************************************************************
+     File:        TrainCars.cpp
+
+     Comment:     Geometry of the train
+
+						See TrainCars.H
+
+     Platform:    Visio Studio.Net 2003/2005
+
+*************************************************************************/
+
+#include <math.h>
+
+#include "TrainCars.H"
+
+// half of the length of a car (in car units), and where the wheels are
+static const float HEAD_LENGTH = 2.0f;
+static const float CAR_LENGTH = 1.0f;
+static const float WHEEL_RADIUS = 0.3f;
+static const float WHEEL_DOWN = -1.2f;
+
+// the cars are 5 world units to the car unit, and ride 1.5 car units
+// above the track
+static const float CAR_SCALE = 5.0f;
+static const float CAR_LIFT = 1.5f;
+
+// colors of the trailing cars, in order
+static const unsigned char CAR_COLORS[7][3] = {
+	{255, 0, 0},
+	{255, 165, 0},
+	{255, 255, 0},
+	{0, 255, 0},
+	{0, 127, 255},
+	{0, 0, 255},
+	{139, 0, 255}
+};
+
+//****************************************************************************
+//
+// *
+//============================================================================
+static void addVertex(vector<CarVertex>& verts, float x, float y, float z,
+					  unsigned char r, unsigned char g, unsigned char b, float a = 0)
+//============================================================================
+{
+	CarVertex v = { x, y, z, r / 255.0f, g / 255.0f, b / 255.0f, a };
+	verts.push_back(v);
+}
+
+//****************************************************************************
+//
+// * A quad as two triangles, corners in order around it
+//============================================================================
+static void addQuad(vector<CarVertex>& verts, const float c[4][3],
+					unsigned char r, unsigned char g, unsigned char b, float a = 0)
+//============================================================================
+{
+	static const int order[6] = { 0, 1, 2, 0, 2, 3 };
+	for (int k = 0; k < 6; k++)
+		addVertex(verts, c[order[k]][0], c[order[k]][1], c[order[k]][2], r, g, b, a);
+}
+
+//****************************************************************************
+//
+// * The engine: an open box with a slanted black hood and yellow sides
+//   on the hood
+//============================================================================
+void makeHeadCarMesh(vector<CarVertex>& verts)
+//============================================================================
+{
+	const float L = HEAD_LENGTH;
+	verts.clear();
+
+	const float back[4][3] = { {-1, -L, -1}, {-1, -L, 0}, {1, -L, 0}, {1, -L, -1} };
+	addQuad(verts, back, 166, 12, 0);
+	const float left[4][3] = { {-1, 0, 0}, {-1, 0, -1}, {-1, -L, -1}, {-1, -L, 0} };
+	addQuad(verts, left, 0, 0, 0);
+	const float right[4][3] = { {1, 0, 0}, {1, 0, -1}, {1, -L, -1}, {1, -L, 0} };
+	addQuad(verts, right, 0, 0, 0);
+
+	for (int side = -1; side <= 1; side += 2) {
+		addVertex(verts, (float)side, 0, 1, 255, 255, 0);
+		addVertex(verts, (float)side, L, -1, 255, 255, 0);
+		addVertex(verts, (float)side, 0, -1, 255, 255, 0);
+
+		float inside = 0.95f * side;
+		addVertex(verts, inside, 0, 1, 0, 0, 0);
+		addVertex(verts, inside, L, -1, 0, 0, 0);
+		addVertex(verts, inside, 0, -1, 0, 0, 0);
+	}
+
+	const float down[4][3] = { {-1, L, -1}, {1, L, -1}, {1, -L, -1}, {-1, -L, -1} };
+	addQuad(verts, down, 0, 0, 0);
+	const float top[4][3] = { {-1, 0, 1}, {1, 0, 1}, {1, L, -1}, {-1, L, -1} };
+	addQuad(verts, top, 0, 0, 0);
+}
+
+//****************************************************************************
+//
+// * A trailing car: an open box in the color of the car, black underneath
+//============================================================================
+void makeCarMesh(vector<CarVertex>& verts)
+//============================================================================
+{
+	const float L = CAR_LENGTH;
+	verts.clear();
+
+	const float back[4][3] = { {-1, -L, -1}, {-1, -L, 0}, {1, -L, 0}, {1, -L, -1} };
+	addQuad(verts, back, 0, 0, 0, 1);
+	const float front[4][3] = { {-1, L, -1}, {-1, L, 0}, {1, L, 0}, {1, L, -1} };
+	addQuad(verts, front, 0, 0, 0, 1);
+	const float left[4][3] = { {-1, L, 0}, {-1, -L, 0}, {-1, -L, -1}, {-1, L, -1} };
+	addQuad(verts, left, 0, 0, 0, 1);
+	const float right[4][3] = { {1, L, 0}, {1, -L, 0}, {1, -L, -1}, {1, L, -1} };
+	addQuad(verts, right, 0, 0, 0, 1);
+	const float down[4][3] = { {-1, L, -1}, {1, L, -1}, {1, -L, -1}, {-1, -L, -1} };
+	addQuad(verts, down, 0, 0, 0);
+}
+
+//****************************************************************************
+//
+// * A disc in the y-z plane, white in the middle and black at the rim
+//============================================================================
+void makeWheelMesh(vector<CarVertex>& verts)
+//============================================================================
+{
+	const int steps = 24;
+	verts.clear();
+	for (int k = 0; k < steps; k++) {
+		float a0 = 2 * 3.14159265f * k / steps;
+		float a1 = 2 * 3.14159265f * (k + 1) / steps;
+		addVertex(verts, 0, 0, 0, 255, 255, 255);
+		addVertex(verts, 0, -sinf(a0) * WHEEL_RADIUS, cosf(a0) * WHEEL_RADIUS, 0, 0, 0);
+		addVertex(verts, 0, -sinf(a1) * WHEEL_RADIUS, cosf(a1) * WHEEL_RADIUS, 0, 0, 0);
+	}
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void TrainPlacement::
+clear()
+//============================================================================
+{
+	head.clear();
+	cars.clear();
+	carColors.clear();
+	wheels.clear();
+	cables.clear();
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+float trainNoseLength()
+//============================================================================
+{
+	return HEAD_LENGTH * CAR_SCALE;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+float trainTailLength(int carCount, float carSpacing)
+//============================================================================
+{
+	if (carCount <= 1)
+		return HEAD_LENGTH * CAR_SCALE;
+	return (carCount - 1) * carSpacing + CAR_LENGTH * CAR_SCALE;
+}
+
+//****************************************************************************
+//
+// * The cars are 2 car units wide and reach from the bottom of the wheels
+//   up to the top of the hood of the engine
+//============================================================================
+void trainCrossSection(float& halfWidth, float& bottom, float& top)
+//============================================================================
+{
+	halfWidth = CAR_SCALE;
+	bottom = (CAR_LIFT + WHEEL_DOWN - WHEEL_RADIUS) * CAR_SCALE;
+	top = (CAR_LIFT + 1) * CAR_SCALE;
+}
+
+//****************************************************************************
+//
+// * Append the transform with axes x, y, z and origin o
+//============================================================================
+static void addTransform(vector<float>& out, const Pnt3f& x, const Pnt3f& y, const Pnt3f& z, const Pnt3f& o)
+//============================================================================
+{
+	float m[16] = {
+		x.x, x.y, x.z, 0,
+		y.x, y.y, y.z, 0,
+		z.x, z.y, z.z, 0,
+		o.x, o.y, o.z, 1
+	};
+	out.insert(out.end(), m, m + 16);
+}
+
+//****************************************************************************
+//
+// * One frame lookup per car. The wheels share the axes of their car and
+//   only move the origin
+//============================================================================
+void placeTrain(const ArcLengthIndex& track, double u, int carCount, float carSpacing,
+				TrainPlacement& out)
+//============================================================================
+{
+	Pnt3f preBack;
+	for (int j = 0; j < carCount; j++) {
+		TrackFrame frame;
+		if (!track.frameAt(u - carSpacing * j, frame))
+			return;
+
+		Pnt3f side = frame.side * CAR_SCALE;
+		Pnt3f forward = frame.forward * CAR_SCALE;
+		Pnt3f up = frame.up * CAR_SCALE;
+		Pnt3f origin = frame.pos + up * CAR_LIFT;
+		float length = (j == 0) ? HEAD_LENGTH : CAR_LENGTH;
+
+		if (j == 0)
+			addTransform(out.head, side, forward, up, origin);
+		else {
+			addTransform(out.cars, side, forward, up, origin);
+			const unsigned char* c = CAR_COLORS[(j - 1) % 7];
+			out.carColors.push_back(c[0] / 255.0f);
+			out.carColors.push_back(c[1] / 255.0f);
+			out.carColors.push_back(c[2] / 255.0f);
+
+			out.cables.push_back(origin + forward * length - up * 0.5f);
+			out.cables.push_back(preBack);
+		}
+
+		for (int w = 0; w < 4; w++) {
+			float along = (w & 1) ? -0.5f * length : 0.5f * length;
+			float across = (w & 2) ? 0.5f : -0.5f;
+			addTransform(out.wheels, side, forward, up,
+						 origin + side * across + forward * along + up * WHEEL_DOWN);
+		}
+		preBack = origin - forward * length - up * 0.5f;
+	}
+}
@@ -0,0 +1,235 @@
+/************************************************************************
+     File:        TrainFleet.cpp
+
+     Comment:     All of the trains on one track
+
+						See TrainFleet.H
+
+     Platform:    Visio Studio.Net 2003/2005
+
+*************************************************************************/
+
+#include <math.h>
+
+#include "TrainFleet.H"
+
+//****************************************************************************
+//
+// * Constructor - one train of 8 cars
+//============================================================================
+TrainFleet::
+TrainFleet()
+	: carSpacing(20), brakeDistance(150), minGap(10), brakeDecel(40),
+	  liftSpeed(60), timeStep(1.0 / 240), maxCatchUp(0.25), pending(0), wanted(1, 8)
+//============================================================================
+{
+	Train t;
+	t.carCount = 8;
+	trains.push_back(t);
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+double TrainFleet::
+length(size_t i) const
+//============================================================================
+{
+	return trainNoseLength() + trainTailLength(trains[i].carCount, carSpacing);
+}
+
+//****************************************************************************
+//
+// * Going backwards means what the chain lift pulls, or with no lift
+//   which way the train rolls
+//============================================================================
+bool TrainFleet::
+goingBack(size_t i) const
+//============================================================================
+{
+	return liftSpeed < 0 || (liftSpeed == 0 && trains[i].physics.speed < 0);
+}
+
+//****************************************************************************
+//
+// * The trains are always spread out again, since longer trains or a
+//   shorter track could leave them overlapping where they are
+//============================================================================
+int TrainFleet::
+setTrains(const ArcLengthIndex& track, const vector<int>& carCounts)
+//============================================================================
+{
+	wanted = carCounts;
+	if (wanted.empty())
+		wanted.push_back(1);
+	for (size_t i = 0; i < wanted.size(); i++)
+		if (wanted[i] < 1) wanted[i] = 1;
+
+	// the trains at the back are left off until the rest fit
+	double total = track.totalLength();
+	size_t count = wanted.size();
+	double used = 0;
+	for (size_t i = 0; i < count; i++)
+		used += trainNoseLength() + trainTailLength(wanted[i], carSpacing) + minGap;
+	while (total > 0 && count > 1 && used > total) {
+		count--;
+		used -= trainNoseLength() + trainTailLength(wanted[count], carSpacing) + minGap;
+	}
+
+	Train lead = trains[0];
+	if (total > 0)
+		lead.physics.position = track.wrap(lead.physics.position);
+	trains.assign(count, lead);
+	double slack = (total > used) ? (total - used) / count : 0;
+	for (size_t i = 0; i < count; i++) {
+		trains[i].carCount = wanted[i];
+		if (i == 0)
+			continue;
+		double ahead = trains[i - 1].physics.position - trainTailLength(wanted[i - 1], carSpacing);
+		double nose = ahead - minGap - slack - trainNoseLength();
+		trains[i].physics.reset(track.wrap(nose), lead.physics.speed);
+	}
+	return (int)count;
+}
+
+//****************************************************************************
+//
+// * Editing the track moves every distance behind the edit, so the
+//   positions are only checked for overlaps, not compared with where they
+//   were
+//============================================================================
+int TrainFleet::
+fit(const ArcLengthIndex& track)
+//============================================================================
+{
+	double total = track.totalLength();
+	if (total <= 0)
+		return (int)trains.size();
+	for (size_t i = 0; i < trains.size(); i++)
+		trains[i].physics.position = track.wrap(trains[i].physics.position);
+
+	// in order the trains and the gaps between them go around the loop
+	// once. More than that and some of them were wrapped past the others
+	bool respace = false;
+	double around = 0;
+	for (size_t i = 0; i < trains.size() && !respace; i++) {
+		double gap = gapAhead(track, i);
+		respace = gap < 0;
+		around += gap + length(i);
+	}
+	if (trains.size() > 1 && around > 1.5 * total)
+		respace = true;
+	if (!respace && trains.size() < wanted.size()) {
+		double used = 0;
+		for (size_t i = 0; i < wanted.size(); i++)
+			used += trainNoseLength() + trainTailLength(wanted[i], carSpacing) + minGap;
+		respace = used <= total;
+	}
+	if (respace)
+		return setTrains(track, wanted);
+	return (int)trains.size();
+}
+
+//****************************************************************************
+//
+// * The distance is taken around the loop, so a gap that comes out as
+//   nearly the whole track is really an overlap
+//============================================================================
+double TrainFleet::
+gapAhead(const ArcLengthIndex& track, size_t i) const
+//============================================================================
+{
+	size_t n = trains.size();
+	double total = track.totalLength();
+	if (n < 2)
+		return total;
+
+	size_t ahead = (i + n - 1) % n;
+	double tail = trains[ahead].physics.position - trainTailLength(trains[ahead].carCount, carSpacing);
+	double nose = trains[i].physics.position + trainNoseLength();
+	double gap = track.wrap(tail - nose);
+	if (gap > total - length(i) - length(ahead))
+		gap -= total;
+	return gap;
+}
+
+//****************************************************************************
+//
+// * All of the trains take each step together, with the brakes set from
+//   where everyone was before it
+//============================================================================
+int TrainFleet::
+advance(const ArcLengthIndex& track, double dt)
+//============================================================================
+{
+	size_t n = trains.size();
+	if (dt <= 0 || track.totalLength() <= 0 || n == 0)
+		return 0;
+
+	pending += (dt < maxCatchUp) ? dt : maxCatchUp;
+	vector<double> limits(n);
+	vector<bool> back(n);
+	int steps = 0;
+	while (pending >= timeStep) {
+		for (size_t i = 0; i < n; i++) {
+			// going backwards the train to look out for is the one behind
+			back[i] = goingBack(i);
+			double room = gapAhead(track, back[i] ? (i + 1) % n : i) - minGap;
+			if (room >= brakeDistance - minGap)
+				limits[i] = 1e30;
+			else
+				limits[i] = (room > 0) ? sqrt(2 * brakeDecel * room) : 0;
+		}
+		for (size_t i = 0; i < n; i++) {
+			TrainPhysics& p = trains[i].physics;
+			p.timeStep = timeStep;
+			p.liftSpeed = liftSpeed;
+			p.speedLimit = limits[i];
+			p.step(track);
+		}
+
+		// the brakes can be a step late - back up anyone who got too close,
+		// with the same direction the brakes used. The ones going forwards
+		// are done front to back, the ones going backwards back to front
+		// and pushed forwards, away from the train behind
+		for (size_t k = 0; k < n && n > 1; k++) {
+			size_t i = (k + 1) % n;
+			size_t ahead = (i + n - 1) % n;
+			double gap = gapAhead(track, i);
+			if (!back[i] && gap < 0) {
+				TrainPhysics& p = trains[i].physics;
+				p.position = track.wrap(p.position + gap);
+				if (p.speed > trains[ahead].physics.speed)
+					p.speed = trains[ahead].physics.speed;
+			}
+		}
+		for (size_t k = 0; k < n && n > 1; k++) {
+			size_t i = (2 * n - 2 - k) % n;
+			size_t behind = (i + 1) % n;
+			double gap = gapAhead(track, behind);
+			if (back[i] && gap < 0) {
+				TrainPhysics& p = trains[i].physics;
+				p.position = track.wrap(p.position - gap);
+				if (p.speed < trains[behind].physics.speed)
+					p.speed = trains[behind].physics.speed;
+			}
+		}
+
+		pending -= timeStep;
+		steps++;
+	}
+	return steps;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void TrainFleet::
+place(const ArcLengthIndex& track, TrainPlacement& out) const
+//============================================================================
+{
+	for (size_t i = 0; i < trains.size(); i++)
+		placeTrain(track, trains[i].physics.position, trains[i].carCount, carSpacing, out);
+}
@@ -0,0 +1,146 @@
+/************************************************************************
+     File:        TrainPhysics.cpp
+
+     Comment:     Moving the train along the track
+
+						See TrainPhysics.H
+
+     Platform:    Visio Studio.Net 2003/2005
+
+*************************************************************************/
+
+#include <math.h>
+
+#include "TrainPhysics.H"
+
+//****************************************************************************
+//
+// * Constructor
+//============================================================================
+TrainPhysics::
+TrainPhysics()
+	: position(0), speed(0), timeStep(1.0 / 240), maxCatchUp(0.25),
+	  gravity(30), friction(0.01), drag(0.0002), liftSpeed(60),
+	  speedLimit(1e30), pending(0)
+//============================================================================
+{
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void TrainPhysics::
+reset(double newPosition, double newSpeed)
+//============================================================================
+{
+	position = newPosition;
+	speed = newSpeed;
+	pending = 0;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+void TrainPhysics::
+sample(const ArcLengthIndex& track, double s, double& height, double& slope) const
+//============================================================================
+{
+	TrackFrame f;
+	if (!track.frameAt(s, f)) {
+		height = slope = 0;
+		return;
+	}
+	height = f.pos.y;
+	slope = f.forward.y;
+}
+
+//****************************************************************************
+//
+// * Gravity pulls down the slope, friction and drag push against the motion
+//============================================================================
+double TrainPhysics::
+acceleration(double slope, double v) const
+//============================================================================
+{
+	double a = -gravity * slope;
+	if (v > 1e-6)
+		a -= friction * gravity + drag * v * v;
+	else if (v < -1e-6)
+		a += friction * gravity + drag * v * v;
+	return a;
+}
+
+//****************************************************************************
+//
+// * Step until less than a step is left over
+//============================================================================
+int TrainPhysics::
+advance(const ArcLengthIndex& track, double dt)
+//============================================================================
+{
+	if (dt <= 0 || track.totalLength() <= 0)
+		return 0;
+
+	pending += (dt < maxCatchUp) ? dt : maxCatchUp;
+	int steps = 0;
+	while (pending >= timeStep) {
+		step(track);
+		pending -= timeStep;
+		steps++;
+	}
+	return steps;
+}
+
+//****************************************************************************
+//
+// * Velocity Verlet, then put the energy back where it belongs. Near a
+//   standstill the speed is left to Verlet, since the sign of the speed
+//   can't be read from the energy
+//============================================================================
+void TrainPhysics::
+step(const ArcLengthIndex& track)
+//============================================================================
+{
+	double h0, slope0;
+	sample(track, position, h0, slope0);
+	double before = 0.5 * speed * speed + gravity * h0;
+
+	double half = speed + 0.5 * timeStep * acceleration(slope0, speed);
+	double next = position + half * timeStep;
+	double h1, slope1;
+	sample(track, next, h1, slope1);
+	double v = half + 0.5 * timeStep * acceleration(slope1, half);
+
+	double moved = fabs(half) * timeStep;
+	double lost = (friction * gravity + drag * half * half) * moved;
+	double kinetic = before - lost - gravity * h1;
+	if (kinetic > 0 && fabs(v) > gravity * timeStep)
+		v = (v > 0 ? 1 : -1) * sqrt(2 * kinetic);
+
+	if (liftSpeed > 0 && v < liftSpeed)
+		v = liftSpeed;
+	else if (liftSpeed < 0 && v > liftSpeed)
+		v = liftSpeed;
+	if (v > speedLimit)
+		v = speedLimit;
+	else if (v < -speedLimit)
+		v = -speedLimit;
+
+	position = track.wrap(next);
+	speed = v;
+}
+
+//****************************************************************************
+//
+// *
+//============================================================================
+double TrainPhysics::
+energy(const ArcLengthIndex& track) const
+//============================================================================
+{
+	double h, slope;
+	sample(track, position, h, slope);
+	return 0.5 * speed * speed + gravity * h;
+}
@@ -33,11 +33,15 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/type_ptr.hpp>
 #include <GL/glu.h>
 
 #include "TrainView.H"
 #include "TrainWindow.H"
 #include "Utilities/3DUtils.H"
+#include "Benchmarks.H"
+#include "Spline.H"
 
 
 
@@ -53,7 +57,163 @@
 #define BLUE2 5
 #define PURPLE 6
 #define PINK 7
-#define DIVIDE_LINE 20.0
+
+// the rides that are in park_bvh, for picking
+static const char* RIDE_NAMES[] = {
+	"cup base", "teapot", "ferris wheel", "wheel", "water slide", "drop tower", "drop tower seat"
+};
+static const int RIDE_COUNT = sizeof(RIDE_NAMES) / sizeof(RIDE_NAMES[0]);
+
+// the other things the id buffer can tell apart
+static const char* CUP_NAMES[] = { "blue", "red", "green", "yellow" };
+static const char* FERRIS_CAR_NAMES[] = {
+	"red", "orange", "yellow", "green", "blue", "light blue", "purple", "pink"
+};
+
+// where the rides stand. The draw functions, buildParkBVH() and drawIds()
+// all use these, so the clearance check and picking see the park the way
+// it is drawn
+static glm::mat4 cupBasePlacement(float time)
+{
+	glm::mat4 model_matrix = glm::mat4();
+	model_matrix = glm::translate(model_matrix, glm::vec3(100, 0, 0));
+	model_matrix = glm::rotate(model_matrix, glm::radians(time), glm::vec3(0, 1, 0));
+	return glm::scale(model_matrix, glm::vec3(75, 60, 75));
+}
+
+static glm::mat4 teapotPlacement(float time)
+{
+	glm::mat4 model_matrix = glm::mat4();
+	model_matrix = glm::translate(model_matrix, glm::vec3(100, 15, 0));
+	model_matrix = glm::rotate(model_matrix, glm::radians(time), glm::vec3(0, 1, 0));
+	return glm::scale(model_matrix, glm::vec3(30, 30, 30));
+}
+
+static glm::mat4 ferrisWheelPlacement()
+{
+	glm::mat4 model_matrix = glm::mat4();
+	model_matrix = glm::translate(model_matrix, glm::vec3(0, 15, -30));
+	return glm::scale(model_matrix, glm::vec3(5, 5, 5.5));
+}
+
+static glm::mat4 wheelPlacement(float time)
+{
+	glm::mat4 model_matrix = glm::mat4();
+	model_matrix = glm::translate(model_matrix, glm::vec3(0, 65, -30));
+	model_matrix = glm::rotate(model_matrix, glm::radians(-1 * time), glm::vec3(0, 0, 1));
+	return glm::scale(model_matrix, glm::vec3(5, 5, 6));
+}
+
+static glm::mat4 waterSlidePlacement()
+{
+	glm::mat4 model_matrix = glm::mat4();
+	model_matrix = glm::translate(model_matrix, glm::vec3(-70, 35, 100));
+	return glm::scale(model_matrix, glm::vec3(3, 3, 3));
+}
+
+static glm::mat4 dropTowerPlacement()
+{
+	glm::mat4 model_matrix = glm::mat4();
+	model_matrix = glm::translate(model_matrix, glm::vec3(-80, 15, -30));
+	return glm::scale(model_matrix, glm::vec3(3, 3, 3));
+}
+
+// a model and where it is drawn
+struct PlacedModel {
+	Model* model;
+	glm::mat4 matrix;
+};
+
+// the rides, in the order of RIDE_NAMES
+static void placeRides(const TrainView* view, PlacedModel rides[])
+{
+	PlacedModel placed[] = {
+		{ view->cup_base, cupBasePlacement(view->time) },
+		{ view->teapot, teapotPlacement(view->time) },
+		{ view->ferris_wheel_main, ferrisWheelPlacement() },
+		{ view->wheel, wheelPlacement(view->time) },
+		{ view->water_slide, waterSlidePlacement() },
+		{ view->drop_tower, dropTowerPlacement() },
+		{ view->drop_tower_seat, dropTowerPlacement() },
+	};
+	for (int r = 0; r < RIDE_COUNT; r++)
+		rides[r] = placed[r];
+}
+
+// the cups, in the order blue, red, green, yellow: where each one starts
+// out on the base and how fast it spins on its own
+static const float CUP_SPOTS[4][4] = {
+	{ 85, 2.5f, 0, -4 }, { 100, 2.5f, -15, -6 }, { 115, 2.5f, 0, 3 }, { 100, 2.5f, 15, 7 }
+};
+
+static glm::mat4 cupPlacement(int cup, float time)
+{
+	glm::vec3 position(CUP_SPOTS[cup][0], CUP_SPOTS[cup][1], CUP_SPOTS[cup][2]);
+	glm::vec3 a = position - glm::vec3(100, 2.5, 0);
+	glm::mat4 mat = glm::rotate(glm::radians(time), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::vec3 b = mat * glm::vec4(a, 1.0);
+
+	glm::mat4 model_matrix = glm::mat4();
+	model_matrix = glm::translate(model_matrix, glm::vec3(100, 2.5, 0));
+	model_matrix = glm::translate(model_matrix, b);
+	model_matrix = glm::scale(model_matrix, glm::vec3(70, 70, 70));
+	return glm::rotate(model_matrix, glm::radians(CUP_SPOTS[cup][3] * time), glm::vec3(0, 1, 0));
+}
+
+// the cars of the ferris wheel, RED .. PINK, where they hang at time 0
+static const float FERRIS_CAR_SPOTS[8][2] = {
+	{ 0, 15 }, { -35.36f, 29.63f }, { -50, 65 }, { -35.36f, 100.36f },
+	{ 0, 115 }, { 35.36f, 100.36f }, { 50, 65 }, { 35.36f, 29.63f }
+};
+
+static glm::mat4 ferrisCarPlacement(int color, float time)
+{
+	glm::vec3 position(FERRIS_CAR_SPOTS[color][0], FERRIS_CAR_SPOTS[color][1], -30);
+	glm::vec3 a = position - glm::vec3(0, 65, -30);
+	glm::mat4 mat = glm::rotate(glm::radians(-1 * time), glm::vec3(0.0f, 0.0f, 1.0f));
+	glm::vec3 b = mat * glm::vec4(a, 1.0);
+
+	glm::mat4 model_matrix = glm::mat4();
+	model_matrix = glm::translate(model_matrix, glm::vec3(0, 65, -30));
+	model_matrix = glm::translate(model_matrix, b);
+	return glm::scale(model_matrix, glm::vec3(5, 5, 5));
+}
+
+// the Frame block of the shaders, as std140 lays it out: the vec3s are
+// padded to vec4s
+struct FrameUniforms {
+	glm::mat4	projection;
+	glm::mat4	view;
+	glm::vec4	eyePos;
+	glm::vec4	lightDirection;
+	glm::vec4	lightAmbient;
+	glm::vec4	lightDiffuse;
+	glm::vec4	lightSpecular;
+};
+
+// put the meshes of model, drawn with shader at matrix, in the render
+// queue. Each mesh brings its own textures, with u_texture on the last
+// of them as the draw functions always had it, unless texture is given:
+// then that one is used in unit 0 instead. Gives back the object
+static int queueModel(RenderQueue& queue, RenderQueue::Pass pass, Model* model, Shader* shader,
+					  const glm::mat4& matrix, float diffuse, float specular, GLuint texture = 0)
+{
+	int object = queue.addObject(shader, matrix, diffuse, specular);
+	for (size_t j = 0; j < model->meshes.size(); j++)
+	{
+		const Mesh& mesh = model->meshes[j];
+		GLuint textures[RenderQueue::MAX_TEXTURES];
+		int count = 0;
+		if (texture)
+			textures[count++] = texture;
+		else
+			for (; count < (int)mesh.textures.size() && count < RenderQueue::MAX_TEXTURES; count++)
+				textures[count] = mesh.textures[count].id;
+		queue.submit(pass, object, mesh, textures, count, count ? count - 1 : 0);
+	}
+	return object;
+}
+
 //************************************************************************
 //
 // * Constructor to set up the GL window
@@ -142,6 +302,8 @@ int TrainView::handle(int event)
 				cp->pos.x = (float) rx;
 				cp->pos.y = (float) ry;
 				cp->pos.z = (float) rz;
+				m_pTrack->mesh.markPointDirty(selectedCube);
+				tw->trackChanged();
 				damage(1);
 			}
 			break;
@@ -158,6 +320,17 @@ int TrainView::handle(int event)
 		case FL_KEYBOARD:
 		 		int k = Fl::event_key();
 				int ks = Fl::event_state();
+				if (k == 'b') {
+					// time the track lookups on a big synthetic track
+					runBenchmarks();
+					return 1;
+				}
+				if (k == 'r') {
+					// print what the next frame costs
+					this->print_frame_stats = true;
+					damage(1);
+					return 1;
+				}
 				if (k == 'p') {
 					// Print out the selected control point information
 					if (selectedCube >= 0) 
@@ -187,6 +360,8 @@ int TrainView::handle(int event)
 //========================================================================
 void TrainView::draw()
 {
+	// uniforms looked up by name before this frame (see the end)
+	unsigned int queries = Shader::locationQueries();
 
 	//*********************************************************************
 	//
@@ -262,6 +437,11 @@ void TrainView::draw()
 			this->water_shader = new Shader( "src/shaders/water.vert",
 				nullptr, nullptr, nullptr,
 				 "src/shaders/water.frag");
+			// the height maps always go in units 1 and 2
+			this->water_shader->Use();
+			this->water_shader->setInt(this->water_shader->uniform("heightMap"), 1);
+			this->water_shader->setInt(this->water_shader->uniform("u_heightMap"), 2);
+			glUseProgram(0);
 			for (int i = 0; i < 200; i++)
 			{
 				std::string str = "Images/waves/";
@@ -300,10 +480,15 @@ void TrainView::draw()
 			this->loadSkyBox(this->skybox_stars_sky, paths);
 			this->skybox_shader = new Shader("src/shaders/cubemap.vert", nullptr, nullptr, nullptr
 				, "src/shaders/cubemap.frag");
+			// the cube map always goes in unit 0
+			this->skybox_shader->Use();
+			this->skybox_shader->setInt(this->skybox_shader->uniform("skybox"), 0);
+			glUseProgram(0);
 		}
 		if (!this->test_ani) {
 			this->test_ani = new AniModel("Models/dae_files/model.dae", "Models/dae_files/diffuse.png");
 			this->test_shader_ani = new Shader("src/shaders/just_ani.vert", nullptr, nullptr, nullptr, "src/shaders/just_ani.frag");
+			this->ani_model = this->test_shader_ani->uniform("model_matrix");
 		}
 		if (!this->cowboy_sit) {
 			this->cowboy_sit = new Model("Models/spinning_cup/boyfriendNeedsHelp_sit.dae");
@@ -373,6 +558,53 @@ void TrainView::draw()
 				nullptr, nullptr, nullptr,
 				 "src/shaders/drop_tower.frag");
 		}
+		if (!this->track_shader)
+		{
+			this->track_shader = new Shader("src/shaders/track.vert",
+				nullptr, nullptr, nullptr,
+				 "src/shaders/track.frag");
+		}
+		if (!this->tile_shader)
+		{
+			this->tile_shader = new Shader("src/shaders/tile.vert",
+				nullptr, nullptr, nullptr,
+				 "src/shaders/tile.frag");
+		}
+		if (!this->support_shader)
+		{
+			this->support_shader = new Shader("src/shaders/support.vert",
+				nullptr, nullptr, nullptr,
+				 "src/shaders/support.frag");
+			this->support_half_width = this->support_shader->uniform("halfWidth");
+		}
+		if (!this->train_shader)
+		{
+			this->train_shader = new Shader("src/shaders/train.vert",
+				nullptr, nullptr, nullptr,
+				 "src/shaders/train.frag");
+		}
+		if (!this->geometry_pool.built())
+		{
+			// every ride in one vertex and one index buffer, for the
+			// render queue
+			Model* rides[] = { this->blue_cup, this->red_cup, this->green_cup, this->yellow_cup,
+							   this->cup_base, this->teapot, this->ferris_wheel_main, this->wheel, this->car,
+							   this->water_slide, this->water, this->drop_tower, this->drop_tower_seat };
+			for (Model* ride : rides)
+				this->geometry_pool.add(ride);
+			this->geometry_pool.build();
+		}
+		if (!this->commom_matrices)
+		{
+			this->commom_matrices = new UBO();
+			this->commom_matrices->size = sizeof(FrameUniforms);
+			glGenBuffers(1, &this->commom_matrices->ubo);
+			glBindBuffer(GL_UNIFORM_BUFFER, this->commom_matrices->ubo);
+			glBufferData(GL_UNIFORM_BUFFER, this->commom_matrices->size, NULL, GL_DYNAMIC_DRAW);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+			// every program has its Frame block on this binding point
+			glBindBufferBase(GL_UNIFORM_BUFFER, Shader::FRAME_BINDING, this->commom_matrices->ubo);
+		}
 	}
 	else
 		throw std::runtime_error("Could not initialize GLAD!");
@@ -392,10 +624,17 @@ void TrainView::draw()
 	// Blayne prefers GL_DIFFUSE
     glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
 
+	// resample the track if it was edited - the train camera needs it
+	m_pTrack->mesh.update(m_pTrack->points, tw->splineBrowser->value());
+	if (!this->park_bvh.nodeCount())
+		buildParkBVH();
+	checkTrackClearance();
+
 	// prepare for projection
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
 	setProjection();		// put the code to set up matrices here
+	this->view_frustum.set(&this->camera.projection[0][0], &this->camera.view[0][0]);
+	// the camera and the light go to all of the shaders at once
+	setUBO();
 
 	//######################################################################
 	// TODO: 
@@ -437,10 +676,18 @@ void TrainView::draw()
 
 	this->drawTrack(this);
 	this->drawTiles();
+	this->drawSupports();
 	if (tw->cameraBrowser->value()!=2)
 	{
 		this->drawTrain(this);
 	}
+	// the sky doesn't write depth, so it goes before everything it is
+	// behind - the water doesn't write depth either
+	this->drawSkybox();
+
+	// the rides only go in the render queue here, if they can be seen;
+	// flush() draws them
+	this->render_queue.setFrustum(&this->view_frustum);
 	this->drawCup(this->blue_cup);
 	this->drawCup(this->red_cup);
 	this->drawCup(this->green_cup);
@@ -457,16 +704,37 @@ void TrainView::draw()
 	this->drawCar(BLUE2);
 	this->drawCar(PURPLE);
 	this->drawCar(PINK);
-	this->drawSkybox();
 	this->drawDropTower();
 	this->drawDropTowerSeat();
-	
-	glEnable(GL_BLEND);
 	this->drawWaterSlide();
-	glDepthMask(GL_FALSE);
 	this->drawWater();
-	glDepthMask(GL_TRUE);
-	glDisable(GL_BLEND);
+	this->render_queue.flush(this->geometry_pool);
+
+	// the culling changes these nearly every frame, so they are only
+	// printed when asked for
+	if (this->print_frame_stats)
+	{
+		const RenderQueue::Counters& drawn = this->render_queue.lastCounters();
+		printf("geometry pool: %u vertices, %u indices\n", (unsigned int)this->geometry_pool.vertexCount(),
+			   (unsigned int)this->geometry_pool.indexCount());
+		printf("render queue: %u meshes, %u programs (%u unsorted), %u textures (%u), %u vertex arrays (%u), "
+			   "%u draw calls (%u)\n",
+			   drawn.items, drawn.programs, drawn.unsortedPrograms, drawn.textures, drawn.unsortedTextures,
+			   drawn.vertexArrays, drawn.unsortedVertexArrays, drawn.drawCalls, drawn.unsortedDrawCalls);
+		printf("  culled %u meshes (%u triangles), drew %u triangles\n", drawn.culledItems, drawn.culledTriangles,
+			   drawn.triangles);
+	}
+
+	// a click that wasn't on a control point: draw the ids under the
+	// current matrices now, and pick up the answer on a later frame
+	if (this->pick_requested)
+	{
+		this->drawIds();
+		this->pick_buffer.requestRead(this->pick_x, this->pick_y);
+		this->pick_requested = false;
+	}
+	if (this->pick_buffer.pending())
+		this->readPick();
 
 
 	if (1) {
@@ -498,16 +766,7 @@ void TrainView::draw()
 
 
 
-			glm::mat4 view_matrix, project_matrix;
-			glGetFloatv(GL_MODELVIEW_MATRIX, &view_matrix[0][0]);
-			glGetFloatv(GL_PROJECTION_MATRIX, &project_matrix[0][0]);
-
-			glUniformMatrix4fv(
-				glGetUniformLocation(this->cowboy_sit_shader_handsUp->Program, "model"), 1, GL_FALSE, &model_matrix[0][0]);
-			glUniformMatrix4fv(
-				glGetUniformLocation(this->cowboy_sit_shader_handsUp->Program, "view"), 1, GL_FALSE, &view_matrix[0][0]);
-			glUniformMatrix4fv(
-				glGetUniformLocation(this->cowboy_sit_shader_handsUp->Program, "projection"), 1, GL_FALSE, &project_matrix[0][0]);
+			this->cowboy_sit_shader_handsUp->setMat4(Shader::MODEL, &model_matrix[0][0]);
 
 			this->cowboy_sit_handsUp->Draw(this->cowboy_sit_shader_handsUp);
 			//unbind VAO
@@ -540,16 +799,7 @@ void TrainView::draw()
 			model_matrix = glm::rotate(model_matrix, glm::radians(this->time * -6), glm::vec3(0, 1, 0));
 			model_matrix = glm::rotate(model_matrix, glm::radians(angle), glm::vec3(1, 0, 0));
 
-			glm::mat4 view_matrix, project_matrix;
-			glGetFloatv(GL_MODELVIEW_MATRIX, &view_matrix[0][0]);
-			glGetFloatv(GL_PROJECTION_MATRIX, &project_matrix[0][0]);
-
-			glUniformMatrix4fv(
-				glGetUniformLocation(this->cowboy_sit_shader->Program, "model"), 1, GL_FALSE, &model_matrix[0][0]);
-			glUniformMatrix4fv(
-				glGetUniformLocation(this->cowboy_sit_shader->Program, "view"), 1, GL_FALSE, &view_matrix[0][0]);
-			glUniformMatrix4fv(
-				glGetUniformLocation(this->cowboy_sit_shader->Program, "projection"), 1, GL_FALSE, &project_matrix[0][0]);
+			this->cowboy_sit_shader->setMat4(Shader::MODEL, &model_matrix[0][0]);
 
 			this->cowboy_sit->Draw(this->cowboy_sit_shader);
 			//unbind VAO
@@ -580,23 +830,11 @@ void TrainView::draw()
 		
 	
 
-		glm::mat4 view_matrix, project_matrix;
-		glGetFloatv(GL_MODELVIEW_MATRIX, &view_matrix[0][0]);
-		glGetFloatv(GL_PROJECTION_MATRIX, &project_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->test_shader_ani->Program, "view_projection_matrix"), 1, GL_FALSE, &(project_matrix * view_matrix)[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->test_shader_ani->Program, "model_matrix"), 1, GL_FALSE, &(model_matrix[0][0]));
-		glm::mat4 view;
-		glGetFloatv(GL_MODELVIEW_MATRIX, &view[0][0]);
-		glm::mat4 inversion = glm::inverse(view);
-		glm::vec3 viewerPos(inversion[3][0], inversion[3][1], inversion[3][2]);
-		glUniform3f(glGetUniformLocation(this->test_shader_ani->Program, "dirLight.direction"), 0, -1.0f, 0);
-		glUniform3f(glGetUniformLocation(this->test_shader_ani->Program, "dirLight.ambient"), 0.1, 0.1, 0.1);
-		glUniform3f(glGetUniformLocation(this->test_shader_ani->Program, "dirLight.diffuse"), 0.5, 0.5, 0.5);
-		glUniform3f(glGetUniformLocation(this->test_shader_ani->Program, "dirLight.specular"), 0.5, 0.5, 0.5);
-
-		glUniform3f(glGetUniformLocation(this->test_shader_ani->Program, "viewPos"), viewerPos.x, viewerPos.y, viewerPos.z);
+		glm::mat3 normal_matrix = glm::inverseTranspose(glm::mat3(model_matrix));
+		this->test_shader_ani->setMat4(this->ani_model, &(model_matrix[0][0]));
+		this->test_shader_ani->setMat3(Shader::NORMAL_MATRIX, &normal_matrix[0][0]);
+		this->test_shader_ani->setFloat(Shader::DIFFUSE_STRENGTH, 1.0f);
+		this->test_shader_ani->setFloat(Shader::SPECULAR_STRENGTH, 0.5f);
 		//float elapsedTime = 0.2;
 
 		this->test_ani->Draw(*test_shader_ani, 0.015*time);
@@ -617,7 +855,7 @@ void TrainView::draw()
 			}
 		}
 		this->psystem->update();
-		this->psystem->renderParticles(*this->particle_shader);
+		this->psystem->renderParticles(*this->particle_shader, this->camera.view);
 	}
 
 	//rendering floor
@@ -630,16 +868,7 @@ void TrainView::draw()
 		//model_matrix = glm::translate(model_matrix, glm::vec3(0, 0, 0));
 		model_matrix = glm::scale(model_matrix, glm::vec3(150, 150, 150));
 
-		glm::mat4 view_matrix, project_matrix;
-		glGetFloatv(GL_MODELVIEW_MATRIX, &view_matrix[0][0]);
-		glGetFloatv(GL_PROJECTION_MATRIX, &project_matrix[0][0]);
-
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->floor_shader->Program, "model"), 1, GL_FALSE, &model_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->floor_shader->Program, "view"), 1, GL_FALSE, &view_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->floor_shader->Program, "projection"), 1, GL_FALSE, &project_matrix[0][0]);
+		this->floor_shader->setMat4(Shader::MODEL, &model_matrix[0][0]);
 		this->floor->Draw(floor_shader);
 
 		//unbind VAO
@@ -648,15 +877,25 @@ void TrainView::draw()
 		//unbind shader(switch to fixed pipeline)
 		glUseProgram(0);
 	}
+
+	// the shaders are made and looked into when they are first used;
+	// after that a frame should need no lookups by name at all
+	queries = Shader::locationQueries() - queries;
+	if (this->print_frame_stats)
+	{
+		printf("%u uniform lookups by name this frame\n", queries);
+		this->print_frame_stats = false;
+	}
 	
 
 }
 
 //************************************************************************
 //
-// * This sets up both the Projection and the ModelView matrices
-//   HOWEVER: it doesn't clear the projection first (the caller handles
-//   that) - its important for picking
+// * This works out the camera for the view picked in the browser - the
+//   projection, the view and the eye, all on the CPU - and then loads it
+//   onto the Projection and ModelView stacks for what is still drawn
+//   with the fixed pipeline and for getMouseLine
 //========================================================================
 void TrainView::
 setProjection()
@@ -666,8 +905,13 @@ setProjection()
 	float aspect = static_cast<float>(w()) / static_cast<float>(h());
 
 	// Check whether we use the world camp
-	if (tw->cameraBrowser->value()==1 || tw->cameraBrowser->value() == 0)
-		arcball.setProjection(false);
+	if (tw->cameraBrowser->value()==1 || tw->cameraBrowser->value() == 0) {
+		HMatrix projection, view;
+		arcball.getProjectionMatrix(projection);
+		arcball.getViewMatrix(view);
+		camera.projection = glm::make_mat4(&projection[0][0]);
+		camera.setView(glm::make_mat4(&view[0][0]));
+	}
 	// Or we use the top cam
 	else if (tw->cameraBrowser->value()==3) {
 		float wi, he;
@@ -682,124 +926,46 @@ setProjection()
 
 		// Set up the top camera drop mode to be orthogonal and set
 		// up proper projection matrix
-		glMatrixMode(GL_PROJECTION);
-		glOrtho(-wi, wi, -he, he, 200, -200);
-		glMatrixMode(GL_MODELVIEW);
-		glLoadIdentity();
-		glRotatef(-90, 1, 0, 0);
+		camera.ortho(-wi, wi, -he, he, 200, -200);
+		camera.setView(glm::rotate(glm::radians(-90.0f), glm::vec3(1, 0, 0)));
 	}
 	else if (tw->cameraBrowser->value()==2)
 	{
-		glMatrixMode(GL_PROJECTION);
-		glLoadIdentity();
-		gluPerspective(30, aspect, 0.001, 500);
-
-		glMatrixMode(GL_MODELVIEW);
-		glLoadIdentity();
-		int i = 0;
-		float t = 0;
-		if (this->trainU > this->totalArc)
-		{
-			this->trainU -= this->totalArc;
-		}
-		double tmp = 0;
-		int count = 0;
-		double position = this->trainU;
-		if (position < 0)
-		{
-			position += this->totalArc;
-		}
-		while (position > tmp)
-		{
-			tmp += this->arc_length[count];
-			count++;
-		}
-		if (tmp == position)
-		{
-			i = (count - 1) / 20;
-			t = ((count - 1) % 20) * 0.05;
-		}
-		else
-		{
-			float x = (position - (tmp - this->arc_length[count - 1])) / ((tmp - position) + (position - (tmp - this->arc_length[count - 1])));
-			i = (count - 1) / 20;
-			t = ((count - 1) % 20 + x) * 0.05;
-		}
-		ControlPoint p0 = m_pTrack->points[i % m_pTrack->points.size()];
-		ControlPoint p1 = m_pTrack->points[(i + 1) % m_pTrack->points.size()];
-		ControlPoint p2 = m_pTrack->points[(i + 2) % m_pTrack->points.size()];
-		ControlPoint p3 = m_pTrack->points[(i + 3) % m_pTrack->points.size()];
-		Pnt3f qt = GMT(p0.pos, p1.pos, p2.pos, p3.pos, tw->splineBrowser->value(), t);
-		Pnt3f nextQt = GMT(p0.pos, p1.pos, p2.pos, p3.pos, tw->splineBrowser->value(), t + 1.0 / DIVIDE_LINE);
-		Pnt3f ori = GMT(p0.orient, p1.orient, p2.orient, p3.orient, tw->splineBrowser->value(), t);
-		Pnt3f forward = nextQt - qt;
-		forward.normalize();
-		Pnt3f cross_t = forward * ori;
-		cross_t.normalize();
-		Pnt3f up = cross_t * forward;
-		up.normalize();
-		this->trainAcc = forward.y * tw->speed->value() * -1;
+		camera.perspective(30, aspect, 0.001f, 500);
+
+		this->trainU = m_pTrack->mesh.arcLength.wrap(this->trainU);
+		TrackFrame frame;
+		m_pTrack->mesh.arcLength.frameAt(this->trainU, frame);
+		Pnt3f qt = frame.pos;
+		Pnt3f forward = frame.forward;
+		Pnt3f up = frame.up;
+		Pnt3f nextQt = qt + forward * 5.0f;
 		Pnt3f pos = qt + up * 5.0f;
 		Pnt3f nextPos = nextQt + up * 5.0f;
 
-		gluLookAt(pos.x, pos.y, pos.z, nextPos.x, nextPos.y, nextPos.z, ori.x, ori.y, ori.z);
+		camera.lookAt(glm::vec3(pos.x, pos.y, pos.z), glm::vec3(nextPos.x, nextPos.y, nextPos.z),
+					  glm::vec3(up.x, up.y, up.z));
 	}
 	else if (tw->cameraBrowser->value()==6)
 	{
-		glMatrixMode(GL_PROJECTION);
-		glLoadIdentity();
-		gluPerspective(60, aspect, 0.01, 500);
-
-		glMatrixMode(GL_MODELVIEW);
-		glLoadIdentity();
-		glm::vec3 position;
-		position = glm::vec3(85, 7, 0);
-		glm::vec3 a = position - glm::vec3(100, 7, 0);
-		glm::mat4 mat = glm::rotate(glm::radians(this->time), glm::vec3(0.0f, 1.0f, 0.0f));
-		glm::vec3 b = mat * glm::vec4(a, 1.0);
-
-		glm::vec3 position2;
-		position2 = glm::vec3(84, 7, 0);
-		glm::vec3 a2 = position2 - position;
-		glm::mat4 mat2 = glm::rotate(glm::radians(this->time*-4), glm::vec3(0.0f, 1.0f, 0.0f));
-		glm::vec3 b2 = mat2 * glm::vec4(a2, 1.0);
-
-		Pnt3f pos((glm::vec3(100, 7, 0) + b+b2).x, (glm::vec3(100, 7, 0) + b+b2).y, (glm::vec3(100, 7, 0) + b+b2).z);
-		//Pnt3f vec((glm::vec3(, 6, 0) + b).x, (glm::vec3(100, 6, 0) + b).y, (glm::vec3(100, 6, 0) + b).z);
-		gluLookAt(pos.x, pos.y, pos.z, (glm::vec3(100, 7, 0) + b).x, (glm::vec3(100, 7, 0) + b).y, (glm::vec3(100, 7, 0) + b).z, 0, 1, 0);
+		// in the blue cup, spinning with it and looking at its middle
+		camera.perspective(60, aspect, 0.01f, 500);
 
+		glm::vec3 center = glm::vec3(cupPlacement(0, this->time)[3]) + glm::vec3(0, 4.5f, 0);
+		glm::mat4 spin = glm::rotate(glm::radians(CUP_SPOTS[0][3] * this->time), glm::vec3(0.0f, 1.0f, 0.0f));
+		camera.lookAt(center + glm::vec3(spin * glm::vec4(-1, 0, 0, 0)), center, glm::vec3(0, 1, 0));
 	}
-	else if (tw->cameraBrowser->value()==4)
+	else if (tw->cameraBrowser->value()==4 || tw->cameraBrowser->value() == 5)
 	{
-		glMatrixMode(GL_PROJECTION);
-		glLoadIdentity();
-		gluPerspective(45, aspect, 0.01, 500);
-
-		glMatrixMode(GL_MODELVIEW);
-		glLoadIdentity();
-		glm::vec3 position;
-		position = glm::vec3(-35.36, 29.63, -30);
-		glm::vec3 a = position - glm::vec3(0, 65, -30);
-		glm::mat4 mat = glm::rotate(glm::radians(-1 * this->time), glm::vec3(0.0f, 0.0f, 1.0f));
-		glm::vec3 b = mat * glm::vec4(a, 1.0);
-		Pnt3f pos((glm::vec3(0, 65, -30) + b).x, (glm::vec3(0, 65, -30) + b).y, (glm::vec3(0, 65, -30) + b).z);
-		gluLookAt(pos.x - 4, pos.y - 5, pos.z + 0.5, pos.x + 100, pos.y - 6, pos.z + 0.5, 0, 1, 0);
-	}
-	else if (tw->cameraBrowser->value() == 5)
-	{
-		glMatrixMode(GL_PROJECTION);
-		glLoadIdentity();
-		gluPerspective(45, aspect, 0.01, 1000);
-
-		glMatrixMode(GL_MODELVIEW);
-		glLoadIdentity();
-		glm::vec3 position;
-		position = glm::vec3(-35.36, 29.63, -30);
-		glm::vec3 a = position - glm::vec3(0, 65, -30);
-		glm::mat4 mat = glm::rotate(glm::radians(-1 * this->time), glm::vec3(0.0f, 0.0f, 1.0f));
-		glm::vec3 b = mat * glm::vec4(a, 1.0);
-		Pnt3f pos((glm::vec3(0, 65, -30) + b).x, (glm::vec3(0, 65, -30) + b).y, (glm::vec3(0, 65, -30) + b).z);
-		gluLookAt(pos.x - 4, pos.y - 5, pos.z + 0.5, pos.x, pos.y - 6, pos.z + 0.5 + 100, 0, 1, 0);
+		// in the orange car of the ferris wheel, looking out sideways (4)
+		// or along the axle (5)
+		bool axle = tw->cameraBrowser->value() == 5;
+		camera.perspective(45, aspect, 0.01f, axle ? 1000.0f : 500.0f);
+
+		glm::vec3 car = glm::vec3(ferrisCarPlacement(ORANGE, this->time)[3]);
+		glm::vec3 from = car + glm::vec3(-4, -5, 0.5f);
+		glm::vec3 to = axle ? car + glm::vec3(0, -6, 100.5f) : car + glm::vec3(100, -6, 0.5f);
+		camera.lookAt(from, to, glm::vec3(0, 1, 0));
 	}
 
 	// Or do the train view or other view here
@@ -809,9 +975,17 @@ setProjection()
 	//####################################################################
 	else {
 #ifdef EXAMPLE_SOLUTION
+		glMatrixMode(GL_PROJECTION);
+		glLoadIdentity();
 		trainCamView(this, aspect);
+		glGetFloatv(GL_PROJECTION_MATRIX, &camera.projection[0][0]);
+		glm::mat4 view;
+		glGetFloatv(GL_MODELVIEW_MATRIX, &view[0][0]);
+		camera.setView(view);
 #endif
 	}
+
+	camera.load();
 }
 
 //************************************************************************
@@ -867,14 +1041,12 @@ void TrainView::drawStuff(bool doingShadows)
 // 
 //************************************************************************
 //
-// * this tries to see which control point is under the mouse
-//	  (for when the mouse is clicked)
-//		it uses OpenGL picking - which is always a trick
-//########################################################################
-// TODO: 
-//		if you want to pick things other than control points, or you
-//		changed how control points are drawn, you might need to change this
-//########################################################################
+// * this tries to see what is under the mouse (for when the mouse is
+//	  clicked). Control points are looked up right away, on the CPU, so
+//	  a drag can start with the next mouse move: the mouse line from the
+//	  near to the far clipping plane is cast into pick_index. Anything
+//	  else is asked of the id buffer the next time the view is drawn (see
+//	  drawIds() and readPick())
 //========================================================================
 void TrainView::
 doPick()
@@ -884,1135 +1056,803 @@ doPick()
 	// active window
 	make_current();		
 
-	// where is the mouse?
-	int mx = Fl::event_x(); 
-	int my = Fl::event_y();
-
-	// get the viewport - most reliable way to turn mouse coords into GL coords
-	int viewport[4];
-	glGetIntegerv(GL_VIEWPORT, viewport);
-
-	// Set up the pick matrix on the stack - remember, FlTk is
-	// upside down!
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity ();
-	gluPickMatrix((double)mx, (double)(viewport[3]-my), 
-						5, 5, viewport);
-
-	// now set up the projection
+	// set up the matrices the mouse line is unprojected with
 	setProjection();
 
-	// now draw the objects - but really only see what we hit
-	GLuint buf[100];
-	glSelectBuffer(100,buf);
-	glRenderMode(GL_SELECT);
-	glInitNames();
-	glPushName(0);
-
-	// draw the cubes, loading the names as we go
-	for(size_t i=0; i<m_pTrack->points.size(); ++i) {
-		glLoadName((GLuint) (i+1));
-		m_pTrack->points[i].draw();
+	m_pTrack->mesh.update(m_pTrack->points, tw->splineBrowser->value());
+	if (this->pick_index_version != m_pTrack->mesh.getVersion() ||
+		this->pick_index_points != m_pTrack->points.size())
+	{
+		this->pick_index.setTrack(m_pTrack->points, m_pTrack->mesh);
+		this->pick_index.setRides(&this->park_bvh);
+		this->pick_index_version = m_pTrack->mesh.getVersion();
+		this->pick_index_points = m_pTrack->points.size();
 	}
 
-	// go back to drawing mode, and see how picking did
-	int hits = glRenderMode(GL_RENDER);
-	if (hits) {
-		// warning; this just grabs the first object hit - if there
-		// are multiple objects, you really want to pick the closest
-		// one - see the OpenGL manual 
-		// remember: we load names that are one more than the index
-		selectedCube = buf[3]-1;
-	} else // nothing hit, nothing selected
-		selectedCube = -1;
-
-	printf("Selected Cube %d\n",selectedCube);
+	selectedCube = -1;
+	selectedSegment = -1;
+	selectedRide = -1;
+	picked_object = 0;
+
+	double r1x, r1y, r1z, r2x, r2y, r2z;
+	if (!getMouseLine(r1x, r1y, r1z, r2x, r2y, r2z, 0, 1))
+		return;
+	Pnt3f origin((float)r1x, (float)r1y, (float)r1z);
+	Pnt3f dir = Pnt3f((float)r2x, (float)r2y, (float)r2z) - origin;
+	float length = dir.getLength();
+	if (length <= 0)
+		return;
+	dir = dir * (1.0f / length);
+
+	PickHit hit;
+	if (this->pick_index.pick(origin, dir, length, hit, PICK_CONTROL_POINT))
+	{
+		selectedCube = hit.index;
+		picked_object = makePickId(PICK_ID_CONTROL_POINT, hit.index);
+		printf("Selected Cube %d\n", selectedCube);
+		return;
+	}
+
+	// the id buffer is upside down from the mouse
+	this->pick_requested = true;
+	this->pick_x = Fl::event_x();
+	this->pick_y = h() - 1 - Fl::event_y();
 }
 
 void TrainView::setUBO()
 {
-	float wdt = this->pixel_w();
-	float hgt = this->pixel_h();
-
-	glm::mat4 view_matrix;
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view_matrix[0][0]);
-	//HMatrix view_matrix; 
-	//this->arcball.getMatrix(view_matrix);
+	FrameUniforms frame;
+	frame.projection = this->camera.projection;
+	frame.view = this->camera.view;
+	frame.eyePos = glm::vec4(this->camera.eye, 1.0f);
 
-	glm::mat4 projection_matrix;
-	glGetFloatv(GL_PROJECTION_MATRIX, &projection_matrix[0][0]);
-	//projection_matrix = glm::perspective(glm::radians(this->arcball.getFoV()), (GLfloat)wdt / (GLfloat)hgt, 0.01f, 1000.0f);
+	// one light for the whole park, straight down
+	frame.lightDirection = glm::vec4(0, -1.0f, 0, 0);
+	frame.lightAmbient = glm::vec4(0.1f, 0.1f, 0.1f, 0);
+	frame.lightDiffuse = glm::vec4(0.5f, 0.5f, 0.5f, 0);
+	frame.lightSpecular = glm::vec4(1.0f, 1.0f, 1.0f, 0);
 
 	glBindBuffer(GL_UNIFORM_BUFFER, this->commom_matrices->ubo);
-	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), &projection_matrix[0][0]);
-	glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), &view_matrix[0][0]);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(frame), &frame);
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
 void TrainView::drawCup(Model* cup)
 {
-	glm::vec3 position;
-	float speed=1;
-	if (cup == this->blue_cup)
-	{
-		position=glm::vec3(85, 2.5, 0);
-		speed = -4;
-	}
-	else if (cup == this->red_cup)
-	{
-		position = glm::vec3(100, 2.5, -15);
-		speed = -6;
-	}
-	else if (cup == this->green_cup)
-	{
-		position = glm::vec3(115, 2.5, 0);
-		speed = 3;
-	}
-	else if (cup == this->yellow_cup)
-	{
-		position = glm::vec3(100, 2.5, 15);
-		speed = 7;
-	}
-	glm::vec3 a = position - glm::vec3(100, 2.5, 0);
-	glm::mat4 mat = glm::rotate(glm::radians(this->time), glm::vec3(0.0f, 1.0f, 0.0f));
-	glm::vec3 b = mat * glm::vec4(a, 1.0);
-	glm::mat4 model_matrix = glm::mat4();
-
-	
-	model_matrix = glm::translate(model_matrix, glm::vec3(100, 2.5, 0));
-	model_matrix = glm::translate(model_matrix, b);
-	model_matrix = glm::scale(model_matrix, glm::vec3(70, 70, 70));
-	model_matrix = glm::rotate(model_matrix, glm::radians(speed * this->time), glm::vec3(0, 1, 0));
-
-	glm::mat4 view_matrix, project_matrix;
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view_matrix[0][0]);
-	glGetFloatv(GL_PROJECTION_MATRIX, &project_matrix[0][0]);
-
-	glm::mat4 view;
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view[0][0]);
-	glm::mat4 inversion = glm::inverse(view);
-	glm::vec3 viewerPos(inversion[3][0], inversion[3][1], inversion[3][2]);
-	this->cup_shader->Use();
-	for (int j = 0; j <cup->meshes.size(); j++)
-	{
-		for (unsigned int i = 0; i < cup->meshes[j].textures.size(); i++)
-		{
-			glActiveTexture(GL_TEXTURE0 + i); // activate proper texture unit before binding
-			glUniform1i(glGetUniformLocation(this->cup_shader->Program,"u_texture"), i);
-			//shader.setFloat(("material." + name + number).c_str(), i);
-			glBindTexture(GL_TEXTURE_2D, cup->meshes[j].textures[i].id);
-		}
-		glActiveTexture(GL_TEXTURE0);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->cup_shader->Program, "model"), 1, GL_FALSE, &model_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->cup_shader->Program, "view"), 1, GL_FALSE, &view_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->cup_shader->Program, "projection"), 1, GL_FALSE, &project_matrix[0][0]);
-
-		glUniform3f(glGetUniformLocation(this->cup_shader->Program, "dirLight.direction"), 0, -1.0f, 0);
-		glUniform3f(glGetUniformLocation(this->cup_shader->Program, "dirLight.ambient"), 0.1, 0.1, 0.1);
-		glUniform3f(glGetUniformLocation(this->cup_shader->Program, "dirLight.diffuse"), 0.5, 0.5, 0.5);
-		glUniform3f(glGetUniformLocation(this->cup_shader->Program, "dirLight.specular"), 1.0, 1.0, 1.0);
-
-		glUniform3f(glGetUniformLocation(this->cup_shader->Program, "viewPos"), viewerPos.x, viewerPos.y, viewerPos.z);
-
-		// draw mesh
-		glBindVertexArray(cup->meshes[j].VAO);
-		glDrawElements(GL_TRIANGLES, cup->meshes[j].indices.size(), GL_UNSIGNED_INT, 0);
-		glBindVertexArray(0);
-
-		// always good practice to set everything back to defaults once configured.
-		glActiveTexture(GL_TEXTURE0);
-	}
+	int k = (cup == this->blue_cup) ? 0 : (cup == this->red_cup) ? 1 : (cup == this->green_cup) ? 2 : 3;
+	queueModel(this->render_queue, RenderQueue::PASS_SOLID, cup, this->cup_shader, cupPlacement(k, this->time),
+			   1.0f, 1.0f);
 }
 
 void TrainView::drawCupBase()
 {
-	glm::mat4 model_matrix = glm::mat4();
-	model_matrix = glm::translate(model_matrix, glm::vec3(100, 0, 0));
-	model_matrix = glm::rotate(model_matrix, glm::radians(this->time), glm::vec3(0, 1, 0));
-	model_matrix = glm::scale(model_matrix, glm::vec3(75, 60, 75));
-
-	glm::mat4 view_matrix, project_matrix;
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view_matrix[0][0]);
-	glGetFloatv(GL_PROJECTION_MATRIX, &project_matrix[0][0]);
-
-	glm::mat4 view;
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view[0][0]);
-	glm::mat4 inversion = glm::inverse(view);
-	glm::vec3 viewerPos(inversion[3][0], inversion[3][1], inversion[3][2]);
+	queueModel(this->render_queue, RenderQueue::PASS_SOLID, this->cup_base, this->cup_base_shader, cupBasePlacement(this->time), 1.0f, 0.1f);
+}
 
-	this->cup_base_shader->Use();
-	for (int j = 0; j < this->cup_base->meshes.size(); j++)
-	{
-		for (unsigned int i = 0; i < this->cup_base->meshes[j].textures.size(); i++)
-		{
-			glActiveTexture(GL_TEXTURE0 + i); // activate proper texture unit before binding
-			glUniform1i(glGetUniformLocation(this->cup_base_shader->Program, "u_texture"), i);
-			//shader.setFloat(("material." + name + number).c_str(), i);
-			glBindTexture(GL_TEXTURE_2D, this->cup_base->meshes[j].textures[i].id);
-		}
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->cup_base_shader->Program, "model"), 1, GL_FALSE, &model_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->cup_base_shader->Program, "view"), 1, GL_FALSE, &view_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->cup_base_shader->Program, "projection"), 1, GL_FALSE, &project_matrix[0][0]);
-
-		glUniform3f(glGetUniformLocation(this->cup_base_shader->Program, "dirLight.direction"), 0, -1.0f, 0);
-		glUniform3f(glGetUniformLocation(this->cup_base_shader->Program, "dirLight.ambient"), 0.1, 0.1, 0.1);
-		glUniform3f(glGetUniformLocation(this->cup_base_shader->Program, "dirLight.diffuse"), 0.5, 0.5, 0.5);
-		glUniform3f(glGetUniformLocation(this->cup_base_shader->Program, "dirLight.specular"), 0.1, 0.1, 0.1);
-
-		glUniform3f(glGetUniformLocation(this->cup_base_shader->Program, "viewPos"), viewerPos.x, viewerPos.y, viewerPos.z);
-		glActiveTexture(GL_TEXTURE0);
-
-		// draw mesh
-		glBindVertexArray(this->cup_base->meshes[j].VAO);
-		glDrawElements(GL_TRIANGLES, this->cup_base->meshes[j].indices.size(), GL_UNSIGNED_INT, 0);
-		glBindVertexArray(0);
+void TrainView::drawTeapot()
+{
+	queueModel(this->render_queue, RenderQueue::PASS_SOLID, this->teapot, this->teapot_shader, teapotPlacement(this->time), 1.0f, 0.1f);
+}
 
-		// always good practice to set everything back to defaults once configured.
-		glActiveTexture(GL_TEXTURE0);
-	}
+void TrainView::drawFerrisWheelMain()
+{
+	queueModel(this->render_queue, RenderQueue::PASS_SOLID, this->ferris_wheel_main, this->ferris_wheel_shader, ferrisWheelPlacement(), 1.0f, 0.3f);
 }
 
-void TrainView::drawTeapot()
+void TrainView::drawWheel()
 {
-	glm::mat4 model_matrix = glm::mat4();
-	model_matrix = glm::translate(model_matrix, glm::vec3(100, 15, 0));
-	model_matrix = glm::rotate(model_matrix, glm::radians(this->time), glm::vec3(0, 1, 0));
-	model_matrix = glm::scale(model_matrix, glm::vec3(30,30,30));
+	queueModel(this->render_queue, RenderQueue::PASS_SOLID, this->wheel, this->ferris_wheel_shader, wheelPlacement(this->time), 1.0f, 1.0f);
+}
 
-	glm::mat4 view_matrix, project_matrix;
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view_matrix[0][0]);
-	glGetFloatv(GL_PROJECTION_MATRIX, &project_matrix[0][0]);
+void TrainView::drawCar(int color)
+{
+	Texture2D* paints[] = { this->car_red, this->car_orange, this->car_yellow, this->car_green,
+							this->car_blue, this->car_blue2, this->car_purple, this->car_pink };
+	queueModel(this->render_queue, RenderQueue::PASS_SOLID, this->car, this->ferris_wheel_shader,
+			   ferrisCarPlacement(color, this->time), 1.0f, 0.5f, paints[color]->getId());
+}
 
-	glm::mat4 view;
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view[0][0]);
-	glm::mat4 inversion = glm::inverse(view);
-	glm::vec3 viewerPos(inversion[3][0], inversion[3][1], inversion[3][2]);
+void TrainView::drawWaterSlide()
+{
+	queueModel(this->render_queue, RenderQueue::PASS_BLEND, this->water_slide, this->water_slide_shader, waterSlidePlacement(), 0.4f, 0.0f);
+}
 
-	this->teapot_shader->Use();
-	for (int j = 0; j < this->teapot->meshes.size(); j++)
+void TrainView::drawWater()
+{
+	int object = this->render_queue.addObject(this->water_shader, waterSlidePlacement(), 1.0f, 1.0f);
+	GLuint height_map = this->height_map[this->count_height_map]->getId();
+	for (int j = 0; j < this->water->meshes.size(); j++)
 	{
-		for (unsigned int i = 0; i < this->teapot->meshes[j].textures.size(); i++)
-		{
-			glActiveTexture(GL_TEXTURE0 + i); // activate proper texture unit before binding
-			glUniform1i(glGetUniformLocation(this->teapot_shader->Program, "u_texture"), i);
-			//shader.setFloat(("material." + name + number).c_str(), i);
-			glBindTexture(GL_TEXTURE_2D, this->teapot->meshes[j].textures[i].id);
-		}
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->teapot_shader->Program, "model"), 1, GL_FALSE, &model_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->teapot_shader->Program, "view"), 1, GL_FALSE, &view_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->teapot_shader->Program, "projection"), 1, GL_FALSE, &project_matrix[0][0]);
-
-		glUniform3f(glGetUniformLocation(this->teapot_shader->Program, "dirLight.direction"), 0, -1.0f, 0);
-		glUniform3f(glGetUniformLocation(this->teapot_shader->Program, "dirLight.ambient"), 0.1, 0.1, 0.1);
-		glUniform3f(glGetUniformLocation(this->teapot_shader->Program, "dirLight.diffuse"), 0.5, 0.5, 0.5);
-		glUniform3f(glGetUniformLocation(this->teapot_shader->Program, "dirLight.specular"), 0.1, 0.1, 0.1);
-
-		glUniform3f(glGetUniformLocation(this->teapot_shader->Program, "viewPos"), viewerPos.x, viewerPos.y, viewerPos.z);
-		glActiveTexture(GL_TEXTURE0);
-
-		// draw mesh
-		glBindVertexArray(this->teapot->meshes[j].VAO);
-		glDrawElements(GL_TRIANGLES, this->teapot->meshes[j].indices.size(), GL_UNSIGNED_INT, 0);
-		glBindVertexArray(0);
-
-		// always good practice to set everything back to defaults once configured.
-		glActiveTexture(GL_TEXTURE0);
+		const Mesh& mesh = this->water->meshes[j];
+		GLuint textures[RenderQueue::MAX_TEXTURES];
+		int count = 0;
+		for (; count < (int)mesh.textures.size() && count < RenderQueue::MAX_TEXTURES; count++)
+			textures[count] = mesh.textures[count].id;
+		GLuint* bound = this->render_queue.submit(RenderQueue::PASS_BLEND_NO_DEPTH, object, mesh, textures, count,
+												  count ? count - 1 : 0);
+		// heightMap and u_heightMap
+		if (bound)
+			bound[1] = bound[2] = height_map;
 	}
 }
 
-void TrainView::drawFerrisWheelMain()
+void TrainView::drawDropTower()
 {
-	glm::mat4 model_matrix = glm::mat4();
-	model_matrix = glm::translate(model_matrix, glm::vec3(0, 15, -30));
-	model_matrix = glm::scale(model_matrix, glm::vec3(5, 5, 5.5));
+	queueModel(this->render_queue, RenderQueue::PASS_SOLID, this->drop_tower, this->drop_tower_shader, dropTowerPlacement(), 1.0f, 0.3f);
+}
+
+void TrainView::drawDropTowerSeat()
+{
+	queueModel(this->render_queue, RenderQueue::PASS_SOLID, this->drop_tower_seat, this->drop_tower_shader, dropTowerPlacement(), 1.0f, 0.3f);
+}
 
-	glm::mat4 view_matrix, project_matrix;
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view_matrix[0][0]);
-	glGetFloatv(GL_PROJECTION_MATRIX, &project_matrix[0][0]);
+void TrainView::drawTrack(TrainView*)
+{
+	const vector<Pnt3f>& rails = m_pTrack->mesh.railVertices;
+	if (rails.empty())
+		return;
 
-	glm::mat4 view;
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view[0][0]);
-	glm::mat4 inversion = glm::inverse(view);
-	glm::vec3 viewerPos(inversion[3][0], inversion[3][1], inversion[3][2]);
+	// only send the rails to the card when the track was rebuilt
+	if (!this->track_rails)
+	{
+		this->track_rails = new VAO;
+		glGenVertexArrays(1, &this->track_rails->vao);
+		glGenBuffers(1, this->track_rails->vbo);
 
-	this->ferris_wheel_shader->Use();
-	for (int j = 0; j < this->ferris_wheel_main->meshes.size(); j++)
+		glBindVertexArray(this->track_rails->vao);
+		glBindBuffer(GL_ARRAY_BUFFER, this->track_rails->vbo[0]);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Pnt3f), (GLvoid*)0);
+		glEnableVertexAttribArray(0);
+		glBindVertexArray(0);
+	}
+	if (this->track_rails_version != m_pTrack->mesh.getVersion())
 	{
-		for (unsigned int i = 0; i < this->ferris_wheel_main->meshes[j].textures.size(); i++)
+		glBindBuffer(GL_ARRAY_BUFFER, this->track_rails->vbo[0]);
+		if (m_pTrack->mesh.wasFullRebuild() ||
+			this->track_rails_version + 1 != m_pTrack->mesh.getVersion() ||
+			this->track_rails->count != rails.size())
 		{
-			glActiveTexture(GL_TEXTURE0 + i); // activate proper texture unit before binding
-			glUniform1i(glGetUniformLocation(this->ferris_wheel_shader->Program, "u_texture"), i);
-			glBindTexture(GL_TEXTURE_2D, this->ferris_wheel_main->meshes[j].textures[i].id);
+			glBufferData(GL_ARRAY_BUFFER, rails.size() * sizeof(Pnt3f), &rails[0], GL_DYNAMIC_DRAW);
+			this->track_rails->count = (unsigned int)rails.size();
 		}
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->ferris_wheel_shader->Program, "model"), 1, GL_FALSE, &model_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->ferris_wheel_shader->Program, "view"), 1, GL_FALSE, &view_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->ferris_wheel_shader->Program, "projection"), 1, GL_FALSE, &project_matrix[0][0]);
-
-		glUniform3f(glGetUniformLocation(this->ferris_wheel_shader->Program, "dirLight.direction"), 0, -1.0f, 0);
-		glUniform3f(glGetUniformLocation(this->ferris_wheel_shader->Program, "dirLight.ambient"), 0.1, 0.1, 0.1);
-		glUniform3f(glGetUniformLocation(this->ferris_wheel_shader->Program, "dirLight.diffuse"), 0.5, 0.5, 0.5);
-		glUniform3f(glGetUniformLocation(this->ferris_wheel_shader->Program, "dirLight.specular"), 0.3, 0.3, 0.3);
-
-		glUniform3f(glGetUniformLocation(this->ferris_wheel_shader->Program, "viewPos"), viewerPos.x, viewerPos.y, viewerPos.z);
-		glActiveTexture(GL_TEXTURE0);
-
-		// draw mesh
-		glBindVertexArray(this->ferris_wheel_main->meshes[j].VAO);
-		glDrawElements(GL_TRIANGLES, this->ferris_wheel_main->meshes[j].indices.size(), GL_UNSIGNED_INT, 0);
-		glBindVertexArray(0);
-
-		// always good practice to set everything back to defaults once configured.
-		glActiveTexture(GL_TEXTURE0);
+		else
+		{
+			// a point was dragged - only its segments need to go over
+			const vector<size_t>& changed = m_pTrack->mesh.getChangedSegments();
+			for (size_t k = 0; k < changed.size(); k++)
+			{
+				size_t first, count;
+				m_pTrack->mesh.getSegmentVertices(changed[k], first, count);
+				glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(Pnt3f), count * sizeof(Pnt3f), &rails[first]);
+			}
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		this->track_rails_version = m_pTrack->mesh.getVersion();
 	}
-}
 
-void TrainView::drawWheel()
-{
 	glm::mat4 model_matrix = glm::mat4();
-	model_matrix = glm::translate(model_matrix, glm::vec3(0, 65, -30));
-	model_matrix = glm::rotate(model_matrix, glm::radians(-1 * this->time), glm::vec3(0, 0, 1));
-	model_matrix = glm::scale(model_matrix, glm::vec3(5, 5, 6));
-
-	glm::mat4 view_matrix, project_matrix;
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view_matrix[0][0]);
-	glGetFloatv(GL_PROJECTION_MATRIX, &project_matrix[0][0]);
 
-	glm::mat4 view;
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view[0][0]);
-	glm::mat4 inversion = glm::inverse(view);
-	glm::vec3 viewerPos(inversion[3][0], inversion[3][1], inversion[3][2]);
+	this->track_shader->Use();
+	this->track_shader->setMat4(Shader::MODEL, &model_matrix[0][0]);
+	this->track_shader->setVec3(Shader::COLOR, 1.0f, 1.0f, 1.0f);
 
-	this->ferris_wheel_shader->Use();
-	for (int j = 0; j < this->wheel->meshes.size(); j++)
+	// one draw per run of chunks in sight
+	const vector<TrackChunk>& chunks = m_pTrack->mesh.chunks;
+	glLineWidth(4);
+	glBindVertexArray(this->track_rails->vao);
+	this->track_chunks_drawn = 0;
+	for (size_t c = 0; c < chunks.size(); )
 	{
-		for (unsigned int i = 0; i < this->wheel->meshes[j].textures.size(); i++)
+		if (!this->view_frustum.intersectsBox(chunks[c].boxMin, chunks[c].boxMax))
 		{
-			glActiveTexture(GL_TEXTURE0 + i); // activate proper texture unit before binding
-			glUniform1i(glGetUniformLocation(this->ferris_wheel_shader->Program, "u_texture"), i);
-			//shader.setFloat(("material." + name + number).c_str(), i);
-			glBindTexture(GL_TEXTURE_2D, this->wheel->meshes[j].textures[i].id);
+			c++;
+			continue;
 		}
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->ferris_wheel_shader->Program, "model"), 1, GL_FALSE, &model_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->ferris_wheel_shader->Program, "view"), 1, GL_FALSE, &view_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->ferris_wheel_shader->Program, "projection"), 1, GL_FALSE, &project_matrix[0][0]);
-
-		glUniform3f(glGetUniformLocation(this->ferris_wheel_shader->Program, "dirLight.direction"), 0, -1.0f, 0);
-		glUniform3f(glGetUniformLocation(this->ferris_wheel_shader->Program, "dirLight.ambient"), 0.1, 0.1, 0.1);
-		glUniform3f(glGetUniformLocation(this->ferris_wheel_shader->Program, "dirLight.diffuse"), 0.5, 0.5, 0.5);
-		glUniform3f(glGetUniformLocation(this->ferris_wheel_shader->Program, "dirLight.specular"), 1.0, 1.0, 1.0);
-
-		glUniform3f(glGetUniformLocation(this->ferris_wheel_shader->Program, "viewPos"), viewerPos.x, viewerPos.y, viewerPos.z);
-		glActiveTexture(GL_TEXTURE0);
-
-		// draw mesh
-		glBindVertexArray(this->wheel->meshes[j].VAO);
-		glDrawElements(GL_TRIANGLES, this->wheel->meshes[j].indices.size(), GL_UNSIGNED_INT, 0);
-		glBindVertexArray(0);
-
-		// always good practice to set everything back to defaults once configured.
-		glActiveTexture(GL_TEXTURE0);
+		size_t first = chunks[c].firstVertex, count = 0;
+		for (; c < chunks.size() && this->view_frustum.intersectsBox(chunks[c].boxMin, chunks[c].boxMax); c++)
+		{
+			count += chunks[c].vertexCount;
+			this->track_chunks_drawn++;
+		}
+		glDrawArrays(GL_LINES, (GLint)first, (GLsizei)count);
 	}
+	glBindVertexArray(0);
+	glUseProgram(0);
 }
 
-void TrainView::drawCar(int color)
+void TrainView::drawTiles()
 {
-	glm::vec3 position;
-	switch (color) {
-	case RED:
-		position = glm::vec3(0, 15, -30);
-		break;
-	case ORANGE:
-		position = glm::vec3(-35.36, 29.63, -30);
-		break;
-	case YELLOW:
-		position = glm::vec3(-50, 65, -30);
-		break;
-	case GREEN:
-		position = glm::vec3(-35.36, 100.36, -30);
-		break;
-	case BLUE:
-		position = glm::vec3(0, 115, -30);
-		break;
-	case BLUE2:
-		position = glm::vec3(35.36, 100.36, -30);
-		break;
-	case PURPLE:
-		position = glm::vec3(50, 65, -30);
-		break;
-	case PINK:
-		position = glm::vec3(35.36, 29.63, -30);
-		break;
-	}
-	glm::vec3 a = position - glm::vec3(0, 65, -30);
-	glm::mat4 mat = glm::rotate(glm::radians(-1 * this->time), glm::vec3(0.0f, 0.0f, 1.0f));
-	glm::vec3 b = mat * glm::vec4(a, 1.0);
-	glm::mat4 model_matrix = glm::mat4();
-	model_matrix = glm::translate(model_matrix, glm::vec3(0, 65, -30));
-	model_matrix = glm::translate(model_matrix, b);
-	model_matrix = glm::scale(model_matrix, glm::vec3(5, 5, 5));
+	const vector<float>& transforms = m_pTrack->mesh.tileTransforms;
 
-	glm::mat4 view_matrix, project_matrix;
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view_matrix[0][0]);
-	glGetFloatv(GL_PROJECTION_MATRIX, &project_matrix[0][0]);
-
-	glm::mat4 view;
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view[0][0]);
-	glm::mat4 inversion = glm::inverse(view);
-	glm::vec3 viewerPos(inversion[3][0], inversion[3][1], inversion[3][2]);
-
-	this->ferris_wheel_shader->Use();
-	for (int j = 0; j < this->car->meshes.size(); j++)
+	// a unit box, and one transform per sleeper as an instanced attribute
+	if (!this->track_tiles)
 	{
+		GLfloat vertices[] = {
+			-1.0f, -1.0f, -1.0f,
+			 1.0f, -1.0f, -1.0f,
+			 1.0f,  1.0f, -1.0f,
+			-1.0f,  1.0f, -1.0f,
+			-1.0f, -1.0f,  1.0f,
+			 1.0f, -1.0f,  1.0f,
+			 1.0f,  1.0f,  1.0f,
+			-1.0f,  1.0f,  1.0f
+		};
+		GLuint elements[] = {
+			4, 5, 6, 4, 6, 7,	// up
+			0, 2, 1, 0, 3, 2,	// down
+			3, 7, 6, 3, 6, 2,	// front
+			0, 1, 5, 0, 5, 4,	// back
+			0, 4, 7, 0, 7, 3,	// left
+			1, 2, 6, 1, 6, 5	// right
+		};
 
-		glUniform1i(glGetUniformLocation(this->ferris_wheel_shader->Program, "u_texture"), 0);
-		switch (color) {
-		case RED:
-			this->car_red->bind(0);
-			break;
-		case ORANGE:
-			this->car_orange->bind(0);
-			break;
-		case YELLOW:
-			this->car_yellow->bind(0);
-			break;
-		case GREEN:
-			this->car_green->bind(0);
-			break;
-		case BLUE:
-			this->car_blue->bind(0);
-			break;
-		case BLUE2:
-			this->car_blue2->bind(0);
-			break;
-		case PURPLE:
-			this->car_purple->bind(0);
-			break;
-		case PINK:
-			this->car_pink->bind(0);
-			break;
-		}
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->ferris_wheel_shader->Program, "model"), 1, GL_FALSE, &model_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->ferris_wheel_shader->Program, "view"), 1, GL_FALSE, &view_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->ferris_wheel_shader->Program, "projection"), 1, GL_FALSE, &project_matrix[0][0]);
-
-		glUniform3f(glGetUniformLocation(this->ferris_wheel_shader->Program, "dirLight.direction"), 0, -1.0f, 0);
-		glUniform3f(glGetUniformLocation(this->ferris_wheel_shader->Program, "dirLight.ambient"), 0.1, 0.1, 0.1);
-		glUniform3f(glGetUniformLocation(this->ferris_wheel_shader->Program, "dirLight.diffuse"), 0.5, 0.5, 0.5);
-		glUniform3f(glGetUniformLocation(this->ferris_wheel_shader->Program, "dirLight.specular"), 0.5, 0.5, 0.5);
-
-		glUniform3f(glGetUniformLocation(this->ferris_wheel_shader->Program, "viewPos"), viewerPos.x, viewerPos.y, viewerPos.z);
-
-		// draw mesh
-		glBindVertexArray(this->car->meshes[j].VAO);
-		glDrawElements(GL_TRIANGLES, this->car->meshes[j].indices.size(), GL_UNSIGNED_INT, 0);
-		glBindVertexArray(0);
+		this->track_tiles = new VAO;
+		this->track_tiles->element_amount = sizeof(elements) / sizeof(GLuint);
+		glGenVertexArrays(1, &this->track_tiles->vao);
+		glGenBuffers(2, this->track_tiles->vbo);
+		glGenBuffers(1, &this->track_tiles->ebo);
 
-		// always good practice to set everything back to defaults once configured.
-		glActiveTexture(GL_TEXTURE0);
-	}
-}
+		glBindVertexArray(this->track_tiles->vao);
 
-void TrainView::drawWaterSlide()
-{
-	glm::mat4 model_matrix = glm::mat4();
-	model_matrix = glm::translate(model_matrix, glm::vec3(-70, 35, 100));
-	model_matrix = glm::scale(model_matrix, glm::vec3(3, 3, 3));
+		glBindBuffer(GL_ARRAY_BUFFER, this->track_tiles->vbo[0]);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
+		glEnableVertexAttribArray(0);
 
-	glm::mat4 view_matrix, project_matrix;
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view_matrix[0][0]);
-	glGetFloatv(GL_PROJECTION_MATRIX, &project_matrix[0][0]);
+		// a mat4 attribute takes 4 locations, one per column
+		glBindBuffer(GL_ARRAY_BUFFER, this->track_tiles->vbo[1]);
+		for (int c = 0; c < 4; c++)
+		{
+			glVertexAttribPointer(1 + c, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(GLfloat), (GLvoid*)(c * 4 * sizeof(GLfloat)));
+			glEnableVertexAttribArray(1 + c);
+			glVertexAttribDivisor(1 + c, 1);
+		}
 
-	glm::mat4 view;
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view[0][0]);
-	glm::mat4 inversion = glm::inverse(view);
-	glm::vec3 viewerPos(inversion[3][0], inversion[3][1], inversion[3][2]);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->track_tiles->ebo);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(elements), elements, GL_STATIC_DRAW);
 
-	this->water_slide_shader->Use();
-	for (int j = 0; j < this->water_slide->meshes.size(); j++)
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+	if (this->track_tiles_version != m_pTrack->mesh.getVersion())
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, this->track_tiles->vbo[1]);
+		if (!transforms.empty())
+			glBufferData(GL_ARRAY_BUFFER, transforms.size() * sizeof(float), &transforms[0], GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		this->track_tiles_count = (unsigned int)(transforms.size() / 16);
+		this->track_tiles_version = m_pTrack->mesh.getVersion();
+	}
+	if (this->track_tiles_count == 0)
+		return;
+
+	this->tile_shader->Use();
+	this->tile_shader->setVec3(Shader::COLOR, 255 / 255.0f, 170 / 255.0f, 249 / 255.0f);
+
+	// GL 3.3 has no base instance, so each run of chunks in sight points
+	// the instance attribute at its first sleeper instead
+	const vector<TrackChunk>& chunks = m_pTrack->mesh.chunks;
+	glBindVertexArray(this->track_tiles->vao);
+	glBindBuffer(GL_ARRAY_BUFFER, this->track_tiles->vbo[1]);
+	for (size_t c = 0; c < chunks.size(); )
 	{
-		for (unsigned int i = 0; i < this->water_slide->meshes[j].textures.size(); i++)
+		if (!this->view_frustum.intersectsBox(chunks[c].boxMin, chunks[c].boxMax))
 		{
-			glActiveTexture(GL_TEXTURE0 + i); // activate proper texture unit before binding
-			glUniform1i(glGetUniformLocation(this->water_slide_shader->Program, "u_texture"), i);
-			//shader.setFloat(("material." + name + number).c_str(), i);
-			glBindTexture(GL_TEXTURE_2D, this->water_slide->meshes[j].textures[i].id);
+			c++;
+			continue;
 		}
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->water_slide_shader->Program, "model"), 1, GL_FALSE, &model_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->water_slide_shader->Program, "view"), 1, GL_FALSE, &view_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->water_slide_shader->Program, "projection"), 1, GL_FALSE, &project_matrix[0][0]);
-
-		glUniform3f(glGetUniformLocation(this->water_slide_shader->Program, "dirLight.direction"), 0, -1.0f, 0);
-		glUniform3f(glGetUniformLocation(this->water_slide_shader->Program, "dirLight.ambient"), 0.1, 0.1, 0.1);
-		glUniform3f(glGetUniformLocation(this->water_slide_shader->Program, "dirLight.diffuse"), 0.2, 0.2, 0.2);
-		glUniform3f(glGetUniformLocation(this->water_slide_shader->Program, "dirLight.specular"), 0.0, 0.0, 0.0);
-
-		glUniform3f(glGetUniformLocation(this->water_slide_shader->Program, "viewPos"), viewerPos.x, viewerPos.y, viewerPos.z);
-		glActiveTexture(GL_TEXTURE0);
-
-		// draw mesh
-		glBindVertexArray(this->water_slide->meshes[j].VAO);
-		glDrawElements(GL_TRIANGLES, this->water_slide->meshes[j].indices.size(), GL_UNSIGNED_INT, 0);
-		glBindVertexArray(0);
-
-		// always good practice to set everything back to defaults once configured.
-		glActiveTexture(GL_TEXTURE0);
+		size_t first = chunks[c].firstTile, count = 0;
+		for (; c < chunks.size() && this->view_frustum.intersectsBox(chunks[c].boxMin, chunks[c].boxMax); c++)
+			count += chunks[c].tileCount;
+		if (count == 0 || first + count > this->track_tiles_count)
+			continue;
+		for (int col = 0; col < 4; col++)
+			glVertexAttribPointer(1 + col, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(GLfloat),
+								  (GLvoid*)((first * 16 + col * 4) * sizeof(GLfloat)));
+		glDrawElementsInstanced(GL_TRIANGLES, this->track_tiles->element_amount, GL_UNSIGNED_INT, 0, (GLsizei)count);
 	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+	glUseProgram(0);
 }
 
-void TrainView::drawWater()
+void TrainView::drawSupports()
 {
-	glm::mat4 model_matrix = glm::mat4();
-	model_matrix = glm::translate(model_matrix, glm::vec3(-70, 35, 100));
-	model_matrix = glm::scale(model_matrix, glm::vec3(3, 3, 3));
+	const vector<float>& instances = m_pTrack->mesh.supportInstances;
 
-	glm::mat4 view_matrix, project_matrix;
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view_matrix[0][0]);
-	glGetFloatv(GL_PROJECTION_MATRIX, &project_matrix[0][0]);
+	// a box from y = 0 to 1 (the shader stretches it down from the top of
+	// each pillar), and x, z, top, height per pillar as an instanced attribute
+	if (!this->track_supports)
+	{
+		GLfloat vertices[] = {
+			-1.0f, 0.0f, -1.0f,
+			 1.0f, 0.0f, -1.0f,
+			 1.0f, 1.0f, -1.0f,
+			-1.0f, 1.0f, -1.0f,
+			-1.0f, 0.0f,  1.0f,
+			 1.0f, 0.0f,  1.0f,
+			 1.0f, 1.0f,  1.0f,
+			-1.0f, 1.0f,  1.0f
+		};
+		GLuint elements[] = {
+			3, 7, 6, 3, 6, 2,	// top
+			0, 1, 5, 0, 5, 4,	// bottom
+			4, 5, 6, 4, 6, 7,	// sides
+			0, 2, 1, 0, 3, 2,
+			0, 4, 7, 0, 7, 3,
+			1, 2, 6, 1, 6, 5
+		};
 
-	glm::mat4 view;
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view[0][0]);
-	glm::mat4 inversion = glm::inverse(view);
-	glm::vec3 viewerPos(inversion[3][0], inversion[3][1], inversion[3][2]);
+		this->track_supports = new VAO;
+		this->track_supports->element_amount = sizeof(elements) / sizeof(GLuint);
+		glGenVertexArrays(1, &this->track_supports->vao);
+		glGenBuffers(2, this->track_supports->vbo);
+		glGenBuffers(1, &this->track_supports->ebo);
 
-	this->water_shader->Use();
-	for (int j = 0; j < this->water->meshes.size(); j++)
+		glBindVertexArray(this->track_supports->vao);
+
+		glBindBuffer(GL_ARRAY_BUFFER, this->track_supports->vbo[0]);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
+		glEnableVertexAttribArray(0);
+
+		glBindBuffer(GL_ARRAY_BUFFER, this->track_supports->vbo[1]);
+		glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid*)0);
+		glEnableVertexAttribArray(1);
+		glVertexAttribDivisor(1, 1);
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->track_supports->ebo);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(elements), elements, GL_STATIC_DRAW);
+
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+	if (this->track_supports_version != m_pTrack->mesh.getVersion())
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, this->track_supports->vbo[1]);
+		if (!instances.empty())
+			glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(float), &instances[0], GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		this->track_supports_count = (unsigned int)(instances.size() / 4);
+		this->track_supports_version = m_pTrack->mesh.getVersion();
+	}
+	if (this->track_supports_count == 0)
+		return;
+
+	this->support_shader->Use();
+	this->support_shader->setFloat(this->support_half_width, 1.0f);
+	this->support_shader->setVec3(Shader::COLOR, 0.55f, 0.55f, 0.6f);
+
+	// same as the sleepers: one instanced call per run of chunks in sight
+	const vector<TrackChunk>& chunks = m_pTrack->mesh.chunks;
+	glBindVertexArray(this->track_supports->vao);
+	glBindBuffer(GL_ARRAY_BUFFER, this->track_supports->vbo[1]);
+	for (size_t c = 0; c < chunks.size(); )
 	{
-		for (unsigned int i = 0; i < this->water->meshes[j].textures.size(); i++)
+		if (!this->view_frustum.intersectsBox(chunks[c].boxMin, chunks[c].boxMax))
 		{
-			glActiveTexture(GL_TEXTURE0 + i); // activate proper texture unit before binding
-			glUniform1i(glGetUniformLocation(this->water_shader->Program, "u_texture"), i);
-			glBindTexture(GL_TEXTURE_2D, this->water->meshes[j].textures[i].id);
+			c++;
+			continue;
 		}
-		glUniform1i(glGetUniformLocation(this->water_shader->Program, "heightMap"), 1);
-		glUniform1i(glGetUniformLocation(this->water_shader->Program, "u_heightMap"), 2);
-		this->height_map[this->count_height_map]->bind(1);
-		this->height_map[this->count_height_map]->bind(2);
-
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->water_shader->Program, "model"), 1, GL_FALSE, &model_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->water_shader->Program, "view"), 1, GL_FALSE, &view_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->water_shader->Program, "projection"), 1, GL_FALSE, &project_matrix[0][0]);
-
-		glUniform3f(glGetUniformLocation(this->water_shader->Program, "dirLight.direction"), 0, -1.0f, 0);
-		glUniform3f(glGetUniformLocation(this->water_shader->Program, "dirLight.ambient"), 0.1, 0.1, 0.1);
-		glUniform3f(glGetUniformLocation(this->water_shader->Program, "dirLight.diffuse"), 0.5, 0.5, 0.5);
-		glUniform3f(glGetUniformLocation(this->water_shader->Program, "dirLight.specular"), 1.0, 1.0, 1.0);
-
-		glUniform3f(glGetUniformLocation(this->water_shader->Program, "viewPos"), viewerPos.x, viewerPos.y, viewerPos.z);
-		glActiveTexture(GL_TEXTURE0);
-
-		// draw mesh
-		glBindVertexArray(this->water->meshes[j].VAO);
-		glDrawElements(GL_TRIANGLES, this->water->meshes[j].indices.size(), GL_UNSIGNED_INT, 0);
-		glBindVertexArray(0);
-
-		// always good practice to set everything back to defaults once configured.
-		glActiveTexture(GL_TEXTURE0);
+		size_t first = chunks[c].firstSupport, count = 0;
+		for (; c < chunks.size() && this->view_frustum.intersectsBox(chunks[c].boxMin, chunks[c].boxMax); c++)
+			count += chunks[c].supportCount;
+		if (count == 0 || first + count > this->track_supports_count)
+			continue;
+		glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid*)(first * 4 * sizeof(GLfloat)));
+		glDrawElementsInstanced(GL_TRIANGLES, this->track_supports->element_amount, GL_UNSIGNED_INT, 0, (GLsizei)count);
 	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+	glUseProgram(0);
 }
 
-void TrainView::drawDropTower()
+void TrainView::drawTrain(TrainView*)
 {
+	this->trainU = m_pTrack->mesh.arcLength.wrap(this->trainU);
 
-	glm::mat4 model_matrix = glm::mat4();
-	model_matrix = glm::translate(model_matrix, glm::vec3(-80, 15, -30));
-	model_matrix = glm::scale(model_matrix, glm::vec3(3,3,3));
+	this->train_placement.clear();
+	tw->fleet.place(m_pTrack->mesh.arcLength, this->train_placement);
 
-	glm::mat4 view_matrix, project_matrix;
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view_matrix[0][0]);
-	glGetFloatv(GL_PROJECTION_MATRIX, &project_matrix[0][0]);
-
-	glm::mat4 view;
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view[0][0]);
-	glm::mat4 inversion = glm::inverse(view);
-	glm::vec3 viewerPos(inversion[3][0], inversion[3][1], inversion[3][2]);
-
-	this->drop_tower_shader->Use();
-	for (int j = 0; j < this->drop_tower->meshes.size(); j++)
+	// the three meshes are made once, the instances go over every frame
+	if (!this->train_meshes[0])
 	{
-		for (unsigned int i = 0; i < this->drop_tower->meshes[j].textures.size(); i++)
+		vector<CarVertex> verts;
+		for (int m = 0; m < 3; m++)
 		{
-			glActiveTexture(GL_TEXTURE0 + i); // activate proper texture unit before binding
-			glUniform1i(glGetUniformLocation(this->drop_tower_shader->Program, "u_texture"), i);
-			glBindTexture(GL_TEXTURE_2D, this->drop_tower->meshes[j].textures[i].id);
+			if (m == 0) makeHeadCarMesh(verts);
+			else if (m == 1) makeCarMesh(verts);
+			else makeWheelMesh(verts);
+
+			VAO* mesh = this->train_meshes[m] = new VAO;
+			mesh->count = (unsigned int)verts.size();
+			glGenVertexArrays(1, &mesh->vao);
+			glGenBuffers(3, mesh->vbo);
+
+			glBindVertexArray(mesh->vao);
+
+			glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo[0]);
+			glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(CarVertex), &verts[0], GL_STATIC_DRAW);
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(CarVertex), (GLvoid*)0);
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(CarVertex), (GLvoid*)(3 * sizeof(float)));
+			glEnableVertexAttribArray(1);
+
+			glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo[1]);
+			for (int c = 0; c < 4; c++)
+			{
+				glVertexAttribPointer(2 + c, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(GLfloat), (GLvoid*)(c * 4 * sizeof(GLfloat)));
+				glEnableVertexAttribArray(2 + c);
+				glVertexAttribDivisor(2 + c, 1);
+			}
+
+			// only the trailing cars have colors of their own - the head
+			// and the wheels keep their vertex colors
+			if (m == 1)
+			{
+				glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo[2]);
+				glVertexAttribPointer(6, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
+				glEnableVertexAttribArray(6);
+				glVertexAttribDivisor(6, 1);
+			}
+
+			glBindVertexArray(0);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
 		}
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->drop_tower_shader->Program, "model"), 1, GL_FALSE, &model_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->drop_tower_shader->Program, "view"), 1, GL_FALSE, &view_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->drop_tower_shader->Program, "projection"), 1, GL_FALSE, &project_matrix[0][0]);
-
-		glUniform3f(glGetUniformLocation(this->drop_tower_shader->Program, "dirLight.direction"), 0, -1.0f, 0);
-		glUniform3f(glGetUniformLocation(this->drop_tower_shader->Program, "dirLight.ambient"), 0.1, 0.1, 0.1);
-		glUniform3f(glGetUniformLocation(this->drop_tower_shader->Program, "dirLight.diffuse"), 0.5, 0.5, 0.5);
-		glUniform3f(glGetUniformLocation(this->drop_tower_shader->Program, "dirLight.specular"), 0.3, 0.3, 0.3);
-
-		glUniform3f(glGetUniformLocation(this->drop_tower_shader->Program, "viewPos"), viewerPos.x, viewerPos.y, viewerPos.z);
-		glActiveTexture(GL_TEXTURE0);
-
-		// draw mesh
-		glBindVertexArray(this->drop_tower->meshes[j].VAO);
-		glDrawElements(GL_TRIANGLES, this->drop_tower->meshes[j].indices.size(), GL_UNSIGNED_INT, 0);
-		glBindVertexArray(0);
 
-		// always good practice to set everything back to defaults once configured.
-		glActiveTexture(GL_TEXTURE0);
+		this->train_cables = new VAO;
+		glGenVertexArrays(1, &this->train_cables->vao);
+		glGenBuffers(1, this->train_cables->vbo);
+		glBindVertexArray(this->train_cables->vao);
+		glBindBuffer(GL_ARRAY_BUFFER, this->train_cables->vbo[0]);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Pnt3f), (GLvoid*)0);
+		glEnableVertexAttribArray(0);
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
-}
 
-void TrainView::drawDropTowerSeat()
-{
 	glm::mat4 model_matrix = glm::mat4();
-	model_matrix = glm::translate(model_matrix, glm::vec3(-80, 15, -30));
-	model_matrix = glm::scale(model_matrix, glm::vec3(3, 3, 3));
-
-	glm::mat4 view_matrix, project_matrix;
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view_matrix[0][0]);
-	glGetFloatv(GL_PROJECTION_MATRIX, &project_matrix[0][0]);
 
-	glm::mat4 view;
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view[0][0]);
-	glm::mat4 inversion = glm::inverse(view);
-	glm::vec3 viewerPos(inversion[3][0], inversion[3][1], inversion[3][2]);
+	this->train_shader->Use();
+	this->drawTrainMesh(this->train_meshes[0], this->train_placement.head, nullptr);
+	this->drawTrainMesh(this->train_meshes[1], this->train_placement.cars, &this->train_placement.carColors);
+	this->drawTrainMesh(this->train_meshes[2], this->train_placement.wheels, nullptr);
 
-	this->drop_tower_shader->Use();
-	for (int j = 0; j < this->drop_tower_seat->meshes.size(); j++)
+	const vector<Pnt3f>& cables = this->train_placement.cables;
+	if (!cables.empty())
 	{
-		for (unsigned int i = 0; i < this->drop_tower_seat->meshes[j].textures.size(); i++)
-		{
-			glActiveTexture(GL_TEXTURE0 + i); // activate proper texture unit before binding
-			glUniform1i(glGetUniformLocation(this->drop_tower_shader->Program, "u_texture"), i);
-			glBindTexture(GL_TEXTURE_2D, this->drop_tower_seat->meshes[j].textures[i].id);
-		}
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->drop_tower_shader->Program, "model"), 1, GL_FALSE, &model_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->drop_tower_shader->Program, "view"), 1, GL_FALSE, &view_matrix[0][0]);
-		glUniformMatrix4fv(
-			glGetUniformLocation(this->drop_tower_shader->Program, "projection"), 1, GL_FALSE, &project_matrix[0][0]);
-
-		glUniform3f(glGetUniformLocation(this->drop_tower_shader->Program, "dirLight.direction"), 0, -1.0f, 0);
-		glUniform3f(glGetUniformLocation(this->drop_tower_shader->Program, "dirLight.ambient"), 0.1, 0.1, 0.1);
-		glUniform3f(glGetUniformLocation(this->drop_tower_shader->Program, "dirLight.diffuse"), 0.5, 0.5, 0.5);
-		glUniform3f(glGetUniformLocation(this->drop_tower_shader->Program, "dirLight.specular"), 0.3, 0.3, 0.3);
-
-		glUniform3f(glGetUniformLocation(this->drop_tower_shader->Program, "viewPos"), viewerPos.x, viewerPos.y, viewerPos.z);
-		glActiveTexture(GL_TEXTURE0);
-
-		// draw mesh
-		glBindVertexArray(this->drop_tower_seat->meshes[j].VAO);
-		glDrawElements(GL_TRIANGLES, this->drop_tower_seat->meshes[j].indices.size(), GL_UNSIGNED_INT, 0);
-		glBindVertexArray(0);
+		this->track_shader->Use();
+		this->track_shader->setMat4(Shader::MODEL, &model_matrix[0][0]);
+		this->track_shader->setVec3(Shader::COLOR, 1.0f, 1.0f, 1.0f);
+
+		glBindBuffer(GL_ARRAY_BUFFER, this->train_cables->vbo[0]);
+		glBufferData(GL_ARRAY_BUFFER, cables.size() * sizeof(Pnt3f), &cables[0], GL_STREAM_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-		// always good practice to set everything back to defaults once configured.
-		glActiveTexture(GL_TEXTURE0);
+		glLineWidth(2);
+		glBindVertexArray(this->train_cables->vao);
+		glDrawArrays(GL_LINES, 0, (GLsizei)cables.size());
+		glBindVertexArray(0);
 	}
+	glUseProgram(0);
 }
 
-void TrainView::drawTrack(TrainView*)
+void TrainView::drawTrainMesh(VAO* mesh, const vector<float>& transforms, const vector<float>* colors)
 {
-	float percent = 1.0f / DIVIDE_LINE;
-	const float railWidth = 2.5f;
-	this->arc_length.clear();
-	this->arc_length.push_back(0);
-	this->totalArc = 0;
-	for (size_t i = 0; i < m_pTrack->points.size(); i++) {
-		// pos
-		ControlPoint p0 = m_pTrack->points[i % m_pTrack->points.size()];
-		ControlPoint p1 = m_pTrack->points[(i + 1) % m_pTrack->points.size()];
-		ControlPoint p2 = m_pTrack->points[(i + 2) % m_pTrack->points.size()];
-		ControlPoint p3 = m_pTrack->points[(i + 3) % m_pTrack->points.size()];
-		// orient
-		float t = percent;
-		float countArcLength = 0.0f;
-		Pnt3f preQt = GMT(p0.pos, p1.pos, p2.pos, p3.pos, tw->splineBrowser->value(), 0);
-		Pnt3f prePreQt;
-		for (size_t j = 0; j < DIVIDE_LINE; j++) {
-			Pnt3f qt = GMT(p0.pos, p1.pos, p2.pos, p3.pos, tw->splineBrowser->value(), t);
-			Pnt3f ori = GMT(p0.orient, p1.orient, p2.orient, p3.orient, tw->splineBrowser->value(), t);
-
-			ori.normalize();
-			Pnt3f cross_t = (qt - preQt) * ori;
-			cross_t.normalize();
-			cross_t = cross_t * railWidth;
-			Pnt3f forward = (qt - preQt);
-			forward.normalize();
-			Pnt3f up = cross_t * forward;
-
-			glLineWidth(4);
-			glBegin(GL_LINES);
-			glColor3ub(255, 255, 255);
-			glVertex3f(preQt.x + cross_t.x, preQt.y + cross_t.y, preQt.z + cross_t.z);
-			glVertex3f(qt.x + cross_t.x, qt.y + cross_t.y, qt.z + cross_t.z);
-			glVertex3f(preQt.x - cross_t.x, preQt.y - cross_t.y, preQt.z - cross_t.z);
-			glVertex3f(qt.x - cross_t.x, qt.y - cross_t.y, qt.z - cross_t.z);
-			glVertex3f(preQt.x + cross_t.x - up.x, preQt.y + cross_t.y - up.y, preQt.z + cross_t.z - up.z);
-			glVertex3f(qt.x + cross_t.x - up.x, qt.y + cross_t.y - up.y, qt.z + cross_t.z - up.z);
-			glVertex3f(preQt.x - cross_t.x - up.x, preQt.y - cross_t.y - up.y, preQt.z - cross_t.z - up.z);
-			glVertex3f(qt.x - cross_t.x - up.x, qt.y - cross_t.y - up.y, qt.z - cross_t.z - up.z);
-			if (j != 0) //fill gap
-			{
-				glVertex3f(prePreQt.x - cross_t.x - up.x, prePreQt.y - cross_t.y - up.y, prePreQt.z - cross_t.z - up.z);
-				glVertex3f(preQt.x - cross_t.x - up.x, preQt.y - cross_t.y - up.y, preQt.z - cross_t.z - up.z);
-				glVertex3f(prePreQt.x - cross_t.x, prePreQt.y - cross_t.y, prePreQt.z - cross_t.z);
-				glVertex3f(preQt.x - cross_t.x, preQt.y - cross_t.y, preQt.z - cross_t.z);
-			}
-			glEnd();
-			this->arc_length.push_back((qt - preQt).getLength());
-			this->totalArc += (qt - preQt).getLength();
-			prePreQt = preQt;
-			preQt = qt;
-			t += percent;
-		}
+	// send this frame's instances of one car mesh over and draw them all
+	GLsizei instances = (GLsizei)(transforms.size() / 16);
+	if (instances == 0)
+		return;
+
+	glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo[1]);
+	glBufferData(GL_ARRAY_BUFFER, transforms.size() * sizeof(float), &transforms[0], GL_STREAM_DRAW);
+	if (colors && !colors->empty())
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo[2]);
+		glBufferData(GL_ARRAY_BUFFER, colors->size() * sizeof(float), &(*colors)[0], GL_STREAM_DRAW);
 	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glBindVertexArray(mesh->vao);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, mesh->count, instances);
+	glBindVertexArray(0);
 }
 
-void TrainView::drawTiles()
+// keeps the view drawing while a pick is on its way back from the card
+static void pickWaitCB(void* view)
 {
-	double accumulate = 3.75;
-	double t = 0;
-	int i = 0;
-	bool ifDraw = true;
-	ControlPoint p0 = m_pTrack->points[i % m_pTrack->points.size()];
-	ControlPoint p1 = m_pTrack->points[(i + 1) % m_pTrack->points.size()];
-	ControlPoint p2 = m_pTrack->points[(i + 2) % m_pTrack->points.size()];
-	ControlPoint p3 = m_pTrack->points[(i + 3) % m_pTrack->points.size()];
-	Pnt3f preQt = GMT(p0.pos, p1.pos, p2.pos, p3.pos, tw->splineBrowser->value(), 0);
-	while (accumulate <= this->totalArc)
-	{
-		double tmp = 0;
-		int count = 0;
-		while (accumulate > tmp)
-		{
-			tmp += this->arc_length[count];
-			count++;
-		}
-		if (tmp == accumulate)
-		{
-			i = (count - 1) / 20;
-			t = ((count - 1) % 20) * 0.05;
-		}
-		else
-		{
-			float x = (accumulate - (tmp - this->arc_length[count - 1])) / ((tmp - accumulate) + (accumulate - (tmp - this->arc_length[count - 1])));
-			i = (count - 1) / 20;
-			t = ((count - 1) % 20 + x) * 0.05;
-		}
+	((TrainView*)view)->damage(1);
+}
 
-		ControlPoint p0 = m_pTrack->points[i % m_pTrack->points.size()];
-		ControlPoint p1 = m_pTrack->points[(i + 1) % m_pTrack->points.size()];
-		ControlPoint p2 = m_pTrack->points[(i + 2) % m_pTrack->points.size()];
-		ControlPoint p3 = m_pTrack->points[(i + 3) % m_pTrack->points.size()];
-		Pnt3f qt = GMT(p0.pos, p1.pos, p2.pos, p3.pos, tw->splineBrowser->value(), t);
-		Pnt3f ori = GMT(p0.orient, p1.orient, p2.orient, p3.orient, tw->splineBrowser->value(), t);
-
-		ori.normalize();
-		Pnt3f cross_t = (qt - preQt) * ori;
-		cross_t.normalize();
-		cross_t = cross_t * 2.5f;
-		Pnt3f forward = qt - preQt;
-		forward.normalize();
-		Pnt3f up = cross_t * forward;
-		up.normalize();
-
-		if (ifDraw)
-		{
-			glColor3ub(255, 170, 249);
-				qt = qt - up;
-				glBegin(GL_QUADS); //up
-				glTexCoord2f(0.0f, 0.0f);
-				glVertex3f(qt.x - 1.5 * cross_t.x + forward.x + up.x, qt.y - 1.5 * cross_t.y + forward.y + up.y, qt.z - 1.5 * cross_t.z + forward.z + up.z);
-				glTexCoord2f(0.0f, 1.0f);
-				glVertex3f(qt.x + 1.5 * cross_t.x + forward.x + up.x, qt.y + 1.5 * cross_t.y + forward.y + up.y, qt.z + 1.5 * cross_t.z + forward.z + up.z);
-				glTexCoord2f(1.0f, 1.0f);
-				glVertex3f(qt.x + 1.5 * cross_t.x - forward.x + up.x, qt.y + 1.5 * cross_t.y - forward.y + up.y, qt.z + 1.5 * cross_t.z - forward.z + up.z);
-				glTexCoord2f(0.0f, 1.0f);
-				glVertex3f(qt.x - 1.5 * cross_t.x - forward.x + up.x, qt.y - 1.5 * cross_t.y - forward.y + up.y, qt.z - 1.5 * cross_t.z - forward.z + up.z);
-				glEnd();
-
-				glBegin(GL_QUADS); //down
-				glTexCoord2f(0.0f, 0.0f);
-				glVertex3f(qt.x - 1.5 * cross_t.x + forward.x - up.x, qt.y - 1.5 * cross_t.y + forward.y - up.y, qt.z - 1.5 * cross_t.z + forward.z - up.z);
-				glTexCoord2f(0.0f, 1.0f);
-				glVertex3f(qt.x + 1.5 * cross_t.x + forward.x - up.x, qt.y + 1.5 * cross_t.y + forward.y - up.y, qt.z + 1.5 * cross_t.z + forward.z - up.z);
-				glTexCoord2f(1.0f, 1.0f);
-				glVertex3f(qt.x + 1.5 * cross_t.x - forward.x - up.x, qt.y + 1.5 * cross_t.y - forward.y - up.y, qt.z + 1.5 * cross_t.z - forward.z - up.z);
-				glTexCoord2f(0.0f, 1.0f);
-				glVertex3f(qt.x - 1.5 * cross_t.x - forward.x - up.x, qt.y - 1.5 * cross_t.y - forward.y - up.y, qt.z - 1.5 * cross_t.z - forward.z - up.z);
-				glEnd();
-
-				glBegin(GL_QUADS); //front
-				glTexCoord2f(0.0f, 0.0f);
-				glVertex3f(qt.x - 1.5 * cross_t.x + forward.x + up.x, qt.y - 1.5 * cross_t.y + forward.y + up.y, qt.z - 1.5 * cross_t.z + forward.z + up.z);
-				glTexCoord2f(0.0f, 1.0f);
-				glVertex3f(qt.x + 1.5 * cross_t.x + forward.x + up.x, qt.y + 1.5 * cross_t.y + forward.y + up.y, qt.z + 1.5 * cross_t.z + forward.z + up.z);
-				glTexCoord2f(1.0f, 1.0f);
-				glVertex3f(qt.x + 1.5 * cross_t.x + forward.x - up.x, qt.y + 1.5 * cross_t.y + forward.y - up.y, qt.z + 1.5 * cross_t.z + forward.z - up.z);
-				glTexCoord2f(0.0f, 1.0f);
-				glVertex3f(qt.x - 1.5 * cross_t.x + forward.x - up.x, qt.y - 1.5 * cross_t.y + forward.y - up.y, qt.z - 1.5 * cross_t.z + forward.z - up.z);
-				glEnd();
-
-				glBegin(GL_QUADS); //back
-				glTexCoord2f(0.0f, 0.0f);
-				glVertex3f(qt.x - 1.5 * cross_t.x - forward.x + up.x, qt.y - 1.5 * cross_t.y - forward.y + up.y, qt.z - 1.5 * cross_t.z - forward.z + up.z);
-				glTexCoord2f(0.0f, 1.0f);
-				glVertex3f(qt.x + 1.5 * cross_t.x - forward.x + up.x, qt.y + 1.5 * cross_t.y - forward.y + up.y, qt.z + 1.5 * cross_t.z - forward.z + up.z);
-				glTexCoord2f(1.0f, 1.0f);
-				glVertex3f(qt.x + 1.5 * cross_t.x - forward.x - up.x, qt.y + 1.5 * cross_t.y - forward.y - up.y, qt.z + 1.5 * cross_t.z - forward.z - up.z);
-				glTexCoord2f(0.0f, 1.0f);
-				glVertex3f(qt.x - 1.5 * cross_t.x - forward.x - up.x, qt.y - 1.5 * cross_t.y - forward.y - up.y, qt.z - 1.5 * cross_t.z - forward.z - up.z);
-				glEnd();
-
-				glBegin(GL_QUADS); //left
-				glTexCoord2f(0.0f, 0.0f);
-				glVertex3f(qt.x - 1.5 * cross_t.x + forward.x + up.x, qt.y - 1.5 * cross_t.y + forward.y + up.y, qt.z - 1.5 * cross_t.z + forward.z + up.z);
-				glTexCoord2f(0.0f, 1.0f);
-				glVertex3f(qt.x - 1.5 * cross_t.x + forward.x - up.x, qt.y - 1.5 * cross_t.y + forward.y - up.y, qt.z - 1.5 * cross_t.z + forward.z - up.z);
-				glTexCoord2f(1.0f, 1.0f);
-				glVertex3f(qt.x - 1.5 * cross_t.x - forward.x - up.x, qt.y - 1.5 * cross_t.y - forward.y - up.y, qt.z - 1.5 * cross_t.z - forward.z - up.z);
-				glTexCoord2f(0.0f, 1.0f);
-				glVertex3f(qt.x - 1.5 * cross_t.x - forward.x + up.x, qt.y - 1.5 * cross_t.y - forward.y + up.y, qt.z - 1.5 * cross_t.z - forward.z + up.z);
-				glEnd();
-
-				glBegin(GL_QUADS); //right
-				glTexCoord2f(0.0f, 0.0f);
-				glVertex3f(qt.x + 1.5 * cross_t.x + forward.x + up.x, qt.y + 1.5 * cross_t.y + forward.y + up.y, qt.z + 1.5 * cross_t.z + forward.z + up.z);
-				glTexCoord2f(0.0f, 1.0f);
-				glVertex3f(qt.x + 1.5 * cross_t.x + forward.x - up.x, qt.y + 1.5 * cross_t.y + forward.y - up.y, qt.z + 1.5 * cross_t.z + forward.z - up.z);
-				glTexCoord2f(1.0f, 1.0f);
-				glVertex3f(qt.x + 1.5 * cross_t.x - forward.x - up.x, qt.y + 1.5 * cross_t.y - forward.y - up.y, qt.z + 1.5 * cross_t.z - forward.z - up.z);
-				glTexCoord2f(0.0f, 1.0f);
-				glVertex3f(qt.x + 1.5 * cross_t.x - forward.x + up.x, qt.y + 1.5 * cross_t.y - forward.y + up.y, qt.z + 1.5 * cross_t.z - forward.z + up.z);
-				glEnd();
-		}
-		ifDraw = !ifDraw;
-		accumulate += 3.75;
-		preQt = qt;
+// draw every mesh of model with the id shader, which is in use
+static void drawModelId(Shader* shader, GLint objectId, Model* model, const glm::mat4& model_matrix, unsigned int id)
+{
+	if (!model)
+		return;
+	shader->setMat4(Shader::MODEL, &model_matrix[0][0]);
+	shader->setUint(objectId, id);
+	// the rides are all in the geometry pool, whose vertex array is bound
+	for (size_t j = 0; j < model->meshes.size(); j++)
+	{
+		const Mesh& mesh = model->meshes[j];
+		glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)mesh.indices.size(), GL_UNSIGNED_INT,
+								 (void*)(mesh.firstIndex * sizeof(unsigned int)), mesh.baseVertex);
 	}
 }
 
-void TrainView::drawTrain(TrainView*)
+void TrainView::drawIds()
 {
-	int color[7][3] = {
-		{255, 0, 0},
-		{ 255, 165, 0},
-		{255, 255, 0},
-		{0, 255, 0},
-		{0, 127, 255},
-		{0, 0, 255 },
-		{139, 0, 255 }
-	};
-	int i = 0;
-	float t = 0;
-	double percent = 1.0f / DIVIDE_LINE;
-	double tmp = 0;
-	int count = 0;
-	if (this->trainU > this->totalArc)
+	if (!this->pick_shader)
 	{
-		this->trainU -= this->totalArc;
+		this->pick_shader = new Shader("src/shaders/pick_id.vert",
+			nullptr, nullptr, nullptr,
+			 "src/shaders/pick_id.frag");
+		this->pick_tile_shader = new Shader("src/shaders/pick_id_tile.vert",
+			nullptr, nullptr, nullptr,
+			 "src/shaders/pick_id.frag");
+		this->pick_support_shader = new Shader("src/shaders/pick_id_support.vert",
+			nullptr, nullptr, nullptr,
+			 "src/shaders/pick_id.frag");
+		this->pick_train_shader = new Shader("src/shaders/pick_id_train.vert",
+			nullptr, nullptr, nullptr,
+			 "src/shaders/pick_id.frag");
+		this->pick_object_id = this->pick_shader->uniform("objectId");
+		this->pick_tile_object_id = this->pick_tile_shader->uniform("objectId");
+		this->pick_tile_id_group = this->pick_tile_shader->uniform("idGroup");
+		this->pick_support_object_id = this->pick_support_shader->uniform("objectId");
+		this->pick_support_half_width = this->pick_support_shader->uniform("halfWidth");
+		this->pick_train_object_id = this->pick_train_shader->uniform("objectId");
 	}
-	Pnt3f preQt;
-	int carNum = 8;
-	for (int j = 0; j < carNum; j++)
+
+	this->pick_buffer.begin(w(), h());
+	glEnable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+
+	// the rides, the cups and the cars of the ferris wheel
+	this->pick_shader->Use();
+	glBindVertexArray(this->geometry_pool.vertexArray());
+	PlacedModel rides[RIDE_COUNT];
+	placeRides(this, rides);
+	for (int r = 0; r < RIDE_COUNT; r++)
+		drawModelId(this->pick_shader, this->pick_object_id, rides[r].model, rides[r].matrix, makePickId(PICK_ID_RIDE, r));
+	Model* cups[] = { this->blue_cup, this->red_cup, this->green_cup, this->yellow_cup };
+	for (int c = 0; c < 4; c++)
+		drawModelId(this->pick_shader, this->pick_object_id, cups[c], cupPlacement(c, this->time), makePickId(PICK_ID_CUP, c));
+	for (int color = RED; color <= PINK; color++)
+		drawModelId(this->pick_shader, this->pick_object_id, this->car, ferrisCarPlacement(color, this->time),
+					makePickId(PICK_ID_FERRIS_CAR, color));
+	glBindVertexArray(0);
+
+	// the control points, as the boxes ControlPoint::draw() makes. They
+	// aren't drawn in the view, but they still hide what is behind them
+	if (this->track_tiles)
 	{
-		double tmp = 0;
-		int count = 0;
-		double pos = this->trainU - 20 * j;
-		if (pos < 0)
-		{
-			pos += this->totalArc;
-		}
-		while (pos > tmp)
-		{
-			tmp += this->arc_length[count];
-			count++;
-		}
-		if (tmp == pos)
-		{
-			i = (count - 1) / 20;
-			t = ((count - 1) % 20) * 0.05;
-		}
-		else
+		glBindVertexArray(this->track_tiles->vao);
+		for (size_t i = 0; i < m_pTrack->points.size(); i++)
 		{
-			float x = (pos - (tmp - this->arc_length[count - 1])) / ((tmp - pos) + (pos - (tmp - this->arc_length[count - 1])));
-			i = (count - 1) / 20;
-			t = ((count - 1) % 20 + x) * 0.05;
+			const Pnt3f& pos = m_pTrack->points[i].pos;
+			glm::mat4 model_matrix = glm::translate(glm::mat4(), glm::vec3(pos.x, pos.y, pos.z));
+			model_matrix = glm::scale(model_matrix, glm::vec3(2, 2, 2));
+			this->pick_shader->setMat4(Shader::MODEL, &model_matrix[0][0]);
+			this->pick_shader->setUint(this->pick_object_id, makePickId(PICK_ID_CONTROL_POINT, (unsigned int)i));
+			glDrawElements(GL_TRIANGLES, this->track_tiles->element_amount, GL_UNSIGNED_INT, 0);
 		}
-		ControlPoint p0 = m_pTrack->points[i % m_pTrack->points.size()];
-		ControlPoint p1 = m_pTrack->points[(i + 1) % m_pTrack->points.size()];
-		ControlPoint p2 = m_pTrack->points[(i + 2) % m_pTrack->points.size()];
-		ControlPoint p3 = m_pTrack->points[(i + 3) % m_pTrack->points.size()];
-		Pnt3f qt = GMT(p0.pos, p1.pos, p2.pos, p3.pos, tw->splineBrowser->value(), t);
-		Pnt3f nextQt = GMT(p0.pos, p1.pos, p2.pos, p3.pos, tw->splineBrowser->value(), t + percent);
-		Pnt3f ori = GMT(p0.orient, p1.orient, p2.orient, p3.orient, tw->splineBrowser->value(), t);
-		Pnt3f forward = nextQt - qt;
-		forward.normalize();
-		Pnt3f cross_t = forward * ori;
-		cross_t.normalize();
-		Pnt3f up = cross_t * forward;
-		up.normalize();
-		if (j == 0)
-		{
-			if (forward.y > 0)
-			{
-				this->trainAcc += forward.y * tw->speed->value() * -0.2;
+		glBindVertexArray(0);
+	}
 
-			}
-			else if (forward.y < 0)
+	// the track: the rails one segment at a time, the sleepers and the
+	// pillars of a chunk in runs that stand on the same segment
+	const vector<TrackChunk>& chunks = m_pTrack->mesh.chunks;
+	if (this->track_rails && this->track_rails->count)
+	{
+		glm::mat4 model_matrix = glm::mat4();
+		this->pick_shader->setMat4(Shader::MODEL, &model_matrix[0][0]);
+		glLineWidth(4);
+		glBindVertexArray(this->track_rails->vao);
+		for (size_t c = 0; c < chunks.size(); c++)
+			for (size_t seg = chunks[c].firstSegment; seg < chunks[c].firstSegment + chunks[c].segmentCount; seg++)
 			{
-				this->trainAcc += forward.y * tw->speed->value() * -0.1;
+				size_t first, count;
+				m_pTrack->mesh.getSegmentVertices(seg, first, count);
+				this->pick_shader->setUint(this->pick_object_id, makePickId(PICK_ID_TRACK, (unsigned int)seg));
+				glDrawArrays(GL_LINES, (GLint)first, (GLsizei)count);
 			}
-			if (this->trainAcc <= 0.7 * tw->speed->value() * -1)
+		glBindVertexArray(0);
+	}
+	if (this->track_tiles && this->track_tiles_count)
+	{
+		this->pick_tile_shader->Use();
+		glBindVertexArray(this->track_tiles->vao);
+		glBindBuffer(GL_ARRAY_BUFFER, this->track_tiles->vbo[1]);
+		for (size_t c = 0; c < chunks.size(); c++)
+		{
+			size_t end = chunks[c].firstTile + chunks[c].tileCount;
+			if (end > this->track_tiles_count)
+				continue;
+			for (size_t first = chunks[c].firstTile; first < end; )
 			{
-				this->trainAcc = 0.7 * tw->speed->value() * -1;
+				int seg = m_pTrack->mesh.getTileSegment(first);
+				size_t count = 1;
+				while (first + count < end && m_pTrack->mesh.getTileSegment(first + count) == seg)
+					count++;
+				this->pick_tile_shader->setUint(this->pick_tile_object_id, makePickId(PICK_ID_TRACK, (unsigned int)seg));
+				this->pick_tile_shader->setUint(this->pick_tile_id_group, (GLuint)count);
+				for (int col = 0; col < 4; col++)
+					glVertexAttribPointer(1 + col, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(GLfloat),
+										  (GLvoid*)((first * 16 + col * 4) * sizeof(GLfloat)));
+				glDrawElementsInstanced(GL_TRIANGLES, this->track_tiles->element_amount, GL_UNSIGNED_INT, 0, (GLsizei)count);
+				first += count;
 			}
 		}
-		cross_t = cross_t * 5;
-		forward = forward * 5;
-		up = up * 5;
-		qt = qt + 1.5 * up;
-		int train_len = 2;
-		float wheel_len = 0.3;
-
-		if (j == 0)
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindVertexArray(0);
+	}
+	if (this->track_supports && this->track_supports_count)
+	{
+		this->pick_support_shader->Use();
+		this->pick_support_shader->setFloat(this->pick_support_half_width, 1.0f);
+		glBindVertexArray(this->track_supports->vao);
+		glBindBuffer(GL_ARRAY_BUFFER, this->track_supports->vbo[1]);
+		for (size_t c = 0; c < chunks.size(); c++)
 		{
-			glColor3ub(166, 12, 0);
-			glBegin(GL_QUADS); //back
-			glTexCoord2f(0.0f, 0.0f);
-			glVertex3f(qt.x - forward.x * train_len - cross_t.x - up.x, qt.y - forward.y * train_len - cross_t.y - up.y, qt.z - forward.z * train_len - cross_t.z - up.z);
-			glTexCoord2f(1.0f, 0.0f);
-			glVertex3f(qt.x - forward.x * train_len - cross_t.x, qt.y - forward.y * train_len - cross_t.y, qt.z - forward.z * train_len - cross_t.z);
-			glTexCoord2f(1.0f, 1.0f);
-			glVertex3f(qt.x - forward.x * train_len + cross_t.x, qt.y - forward.y * train_len + cross_t.y, qt.z - forward.z * train_len + cross_t.z);
-			glTexCoord2f(0.0f, 1.0f);
-			glVertex3f(qt.x - forward.x * train_len + cross_t.x - up.x, qt.y - forward.y * train_len + cross_t.y - up.y, qt.z - forward.z * train_len + cross_t.z - up.z);
-			glEnd();
-
-			glColor3ub(0, 0, 0);
-			glBegin(GL_QUADS); //left quad
-			glTexCoord2f(0.0f, 0.0f);
-			glVertex3f(qt.x - cross_t.x, qt.y - cross_t.y, qt.z - cross_t.z);
-			glTexCoord2f(1.0f, 0.0f);
-			glVertex3f(qt.x - cross_t.x - up.x, qt.y - cross_t.y - up.y, qt.z - cross_t.z - up.z);
-			glTexCoord2f(1.0f, 1.0f);
-			glVertex3f(qt.x - forward.x * train_len - cross_t.x - up.x, qt.y - forward.y * train_len - cross_t.y - up.y, qt.z - forward.z * train_len - cross_t.z - up.z);
-			glTexCoord2f(0.0f, 1.0f);
-			glVertex3f(qt.x - forward.x * train_len - cross_t.x, qt.y - forward.y * train_len - cross_t.y, qt.z - forward.z * train_len - cross_t.z);
-			glEnd();
-
-			glBegin(GL_QUADS); //right quad
-			glTexCoord2f(0.0f, 0.0f);
-			glVertex3f(qt.x + cross_t.x, qt.y + cross_t.y, qt.z + cross_t.z);
-			glTexCoord2f(1.0f, 0.0f);
-			glVertex3f(qt.x + cross_t.x - up.x, qt.y + cross_t.y - up.y, qt.z + cross_t.z - up.z);
-			glTexCoord2f(1.0f, 1.0f);
-			glVertex3f(qt.x - forward.x * train_len + cross_t.x - up.x, qt.y - forward.y * train_len + cross_t.y - up.y, qt.z - forward.z * train_len + cross_t.z - up.z);
-			glTexCoord2f(0.0f, 1.0f);
-			glVertex3f(qt.x - forward.x * train_len + cross_t.x, qt.y - forward.y * train_len + cross_t.y, qt.z - forward.z * train_len + cross_t.z);
-			glEnd();
-
-			glColor3ub(255, 255, 0);
-			glBegin(GL_TRIANGLES); //left triangle
-			glVertex3f(qt.x - cross_t.x + up.x, qt.y - cross_t.y + up.y, qt.z - cross_t.z + up.z);
-			glVertex3f(qt.x + forward.x * train_len - cross_t.x - up.x, qt.y + forward.y * train_len - cross_t.y - up.y, qt.z + forward.z * train_len - cross_t.z - up.z);
-			glVertex3f(qt.x - cross_t.x - up.x, qt.y - cross_t.y - up.y, qt.z - cross_t.z - up.z);
-			glEnd();
-
-			glBegin(GL_TRIANGLES); //right triangle
-			glVertex3f(qt.x + cross_t.x + up.x, qt.y + cross_t.y + up.y, qt.z + cross_t.z + up.z);
-			glVertex3f(qt.x + forward.x * train_len + cross_t.x - up.x, qt.y + forward.y * train_len + cross_t.y - up.y, qt.z + forward.z * train_len + cross_t.z - up.z);
-			glVertex3f(qt.x + cross_t.x - up.x, qt.y + cross_t.y - up.y, qt.z + cross_t.z - up.z);
-			glEnd();
-
-
-			glColor3ub(0, 0, 0);
-			glBegin(GL_TRIANGLES); //left triangle inside
-			glVertex3f(qt.x - 0.95 * cross_t.x + up.x, qt.y - 0.95 * cross_t.y + up.y, qt.z - 0.95 * cross_t.z + up.z);
-			glVertex3f(qt.x + forward.x * train_len - 0.95 * cross_t.x - up.x, qt.y + forward.y * train_len - 0.95 * cross_t.y - up.y, qt.z + forward.z * train_len - 0.95 * cross_t.z - up.z);
-			glVertex3f(qt.x - 0.95 * cross_t.x - up.x, qt.y - 0.95 * cross_t.y - up.y, qt.z - 0.95 * cross_t.z - up.z);
-			glEnd();
-
-			glBegin(GL_TRIANGLES); //right triangle inside
-			glVertex3f(qt.x + 0.95 * cross_t.x + up.x, qt.y + 0.95 * cross_t.y + up.y, qt.z + 0.95 * cross_t.z + up.z);
-			glVertex3f(qt.x + forward.x * train_len + 0.95 * cross_t.x - up.x, qt.y + forward.y * train_len + 0.95 * cross_t.y - up.y, qt.z + forward.z * train_len + 0.95 * cross_t.z - up.z);
-			glVertex3f(qt.x + 0.95 * cross_t.x - up.x, qt.y + 0.95 * cross_t.y - up.y, qt.z + 0.95 * cross_t.z - up.z);
-			glEnd();
-
-			glBegin(GL_QUADS); //down
-			glTexCoord2f(0.0f, 0.0f);
-			glVertex3f(qt.x + forward.x * train_len - cross_t.x - up.x, qt.y + forward.y * train_len - cross_t.y - up.y, qt.z + forward.z * train_len - cross_t.z - up.z);
-			glTexCoord2f(1.0f, 0.0f);
-			glVertex3f(qt.x + forward.x * train_len + cross_t.x - up.x, qt.y + forward.y * train_len + cross_t.y - up.y, qt.z + forward.z * train_len + cross_t.z - up.z);
-			glTexCoord2f(1.0f, 1.0f);
-			glVertex3f(qt.x - forward.x * train_len + cross_t.x - up.x, qt.y - forward.y * train_len + cross_t.y - up.y, qt.z - forward.z * train_len + cross_t.z - up.z);
-			glTexCoord2f(0.0f, 1.0f);
-			glVertex3f(qt.x - forward.x * train_len - cross_t.x - up.x, qt.y - forward.y * train_len - cross_t.y - up.y, qt.z - forward.z * train_len - cross_t.z - up.z);
-			glEnd();
-
-
-			glColor3ub(0, 0, 0);
-			glBegin(GL_QUADS); //top
-			glTexCoord2f(0.0f, 0.0f);
-			glVertex3f(qt.x + -cross_t.x + up.x, qt.y - cross_t.y + up.y, qt.z - cross_t.z + up.z);
-			glTexCoord2f(1.0f, 0.0f);
-			glVertex3f(qt.x + cross_t.x + up.x, qt.y + cross_t.y + up.y, qt.z + cross_t.z + up.z);
-			glTexCoord2f(1.0f, 1.0f);
-			glVertex3f(qt.x + forward.x * train_len + cross_t.x - up.x, qt.y + forward.y * train_len + cross_t.y - up.y, qt.z + forward.z * train_len + cross_t.z - up.z);
-			glTexCoord2f(0.0f, 1.0f);
-			glVertex3f(qt.x + forward.x * train_len - cross_t.x - up.x, qt.y + forward.y * train_len - cross_t.y - up.y, qt.z + forward.z * train_len - cross_t.z - up.z);
-			glEnd();
-
+			size_t end = chunks[c].firstSupport + chunks[c].supportCount;
+			if (end > this->track_supports_count)
+				continue;
+			for (size_t first = chunks[c].firstSupport; first < end; )
+			{
+				int seg = m_pTrack->mesh.getSupportSegment(first);
+				size_t count = 1;
+				while (first + count < end && m_pTrack->mesh.getSupportSegment(first + count) == seg)
+					count++;
+				this->pick_support_shader->setUint(this->pick_support_object_id, makePickId(PICK_ID_TRACK, (unsigned int)seg));
+				glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid*)(first * 4 * sizeof(GLfloat)));
+				glDrawElementsInstanced(GL_TRIANGLES, this->track_supports->element_amount, GL_UNSIGNED_INT, 0, (GLsizei)count);
+				first += count;
+			}
 		}
-		else
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindVertexArray(0);
+	}
+
+	// the trains, with the instances drawTrain() sent over this frame. The
+	// trains can have different numbers of cars, so each one is its own
+	// run of instances and gets its own draw - head, cars and wheels of
+	// train i all get id i
+	if (this->train_meshes[0] && tw->cameraBrowser->value() != 2 && !tw->fleet.trains.empty())
+	{
+		const vector<float>* transforms[3] = {
+			&this->train_placement.head, &this->train_placement.cars, &this->train_placement.wheels
+		};
+		this->pick_train_shader->Use();
+		for (int m = 0; m < 3; m++)
 		{
-			forward = forward * 0.5;
-
-			glBegin(GL_LINES); //connect cable
-			glLineWidth(2);
-
-			glColor3ub(255, 255, 255);
-			glVertex3f(qt.x + forward.x * train_len - 0.5 * up.x, qt.y + forward.y * train_len - 0.5 * up.y, qt.z + forward.z * train_len - 0.5 * up.z);
-			glVertex3f(preQt.x, preQt.y, preQt.z);
-			glEnd();
-
-
-			glColor3ub(color[(j - 1) % 7][0], color[(j - 1) % 7][1], color[(j - 1) % 7][2]);
-			glBegin(GL_QUADS); //back
-			glTexCoord2f(0.0f, 0.0f);
-			glVertex3f(qt.x - forward.x * train_len - cross_t.x - up.x, qt.y - forward.y * train_len - cross_t.y - up.y, qt.z - forward.z * train_len - cross_t.z - up.z);
-			glTexCoord2f(1.0f, 0.0f);
-			glVertex3f(qt.x - forward.x * train_len - cross_t.x, qt.y - forward.y * train_len - cross_t.y, qt.z - forward.z * train_len - cross_t.z);
-			glTexCoord2f(1.0f, 1.0f);
-			glVertex3f(qt.x - forward.x * train_len + cross_t.x, qt.y - forward.y * train_len + cross_t.y, qt.z - forward.z * train_len + cross_t.z);
-			glTexCoord2f(0.0f, 1.0f);
-			glVertex3f(qt.x - forward.x * train_len + cross_t.x - up.x, qt.y - forward.y * train_len + cross_t.y - up.y, qt.z - forward.z * train_len + cross_t.z - up.z);
-			glEnd();
-
-			glBegin(GL_QUADS); //front
-			glTexCoord2f(0.0f, 0.0f);
-			glVertex3f(qt.x + forward.x * train_len - cross_t.x - up.x, qt.y + forward.y * train_len - cross_t.y - up.y, qt.z + forward.z * train_len - cross_t.z - up.z);
-			glTexCoord2f(1.0f, 0.0f);
-			glVertex3f(qt.x + forward.x * train_len - cross_t.x, qt.y + forward.y * train_len - cross_t.y, qt.z + forward.z * train_len - cross_t.z);
-			glTexCoord2f(1.0f, 1.0f);
-			glVertex3f(qt.x + forward.x * train_len + cross_t.x, qt.y + forward.y * train_len + cross_t.y, qt.z + forward.z * train_len + cross_t.z);
-			glTexCoord2f(0.0f, 1.0f);
-			glVertex3f(qt.x + forward.x * train_len + cross_t.x - up.x, qt.y + forward.y * train_len + cross_t.y - up.y, qt.z + forward.z * train_len + cross_t.z - up.z);
-			glEnd();
-
-			glBegin(GL_QUADS); //left
-			glTexCoord2f(0.0f, 0.0f);
-			glVertex3f(qt.x + forward.x * train_len - cross_t.x, qt.y + forward.y * train_len - cross_t.y, qt.z + forward.z * train_len - cross_t.z);
-			glTexCoord2f(1.0f, 0.0f);
-			glVertex3f(qt.x - forward.x * train_len - cross_t.x, qt.y - forward.y * train_len - cross_t.y, qt.z - forward.z * train_len - cross_t.z);
-			glTexCoord2f(1.0f, 1.0f);
-			glVertex3f(qt.x - forward.x * train_len - cross_t.x - up.x, qt.y - forward.y * train_len - cross_t.y - up.y, qt.z - forward.z * train_len - cross_t.z - up.z);
-			glTexCoord2f(0.0f, 1.0f);
-			glVertex3f(qt.x + forward.x * train_len - cross_t.x - up.x, qt.y + forward.y * train_len - cross_t.y - up.y, qt.z + forward.z * train_len - cross_t.z - up.z);
-			glEnd();
-
-
-			glBegin(GL_QUADS); //right
-			glTexCoord2f(0.0f, 0.0f);
-			glVertex3f(qt.x + forward.x * train_len + cross_t.x, qt.y + forward.y * train_len + cross_t.y, qt.z + forward.z * train_len + cross_t.z);
-			glTexCoord2f(1.0f, 0.0f);
-			glVertex3f(qt.x - forward.x * train_len + cross_t.x, qt.y - forward.y * train_len + cross_t.y, qt.z - forward.z * train_len + cross_t.z);
-			glTexCoord2f(1.0f, 1.0f);
-			glVertex3f(qt.x - forward.x * train_len + cross_t.x - up.x, qt.y - forward.y * train_len + cross_t.y - up.y, qt.z - forward.z * train_len + cross_t.z - up.z);
-			glTexCoord2f(0.0f, 1.0f);
-			glVertex3f(qt.x + forward.x * train_len + cross_t.x - up.x, qt.y + forward.y * train_len + cross_t.y - up.y, qt.z + forward.z * train_len + cross_t.z - up.z);
-			glEnd();
-
-			glColor3ub(0, 0, 0);
-			glBegin(GL_QUADS); //down
-			glTexCoord2f(0.0f, 0.0f);
-			glVertex3f(qt.x + forward.x * train_len - cross_t.x - up.x, qt.y + forward.y * train_len - cross_t.y - up.y, qt.z + forward.z * train_len - cross_t.z - up.z);
-			glTexCoord2f(1.0f, 0.0f);
-			glVertex3f(qt.x + forward.x * train_len + cross_t.x - up.x, qt.y + forward.y * train_len + cross_t.y - up.y, qt.z + forward.z * train_len + cross_t.z - up.z);
-			glTexCoord2f(1.0f, 1.0f);
-			glVertex3f(qt.x - forward.x * train_len + cross_t.x - up.x, qt.y - forward.y * train_len + cross_t.y - up.y, qt.z - forward.z * train_len + cross_t.z - up.z);
-			glTexCoord2f(0.0f, 1.0f);
-			glVertex3f(qt.x - forward.x * train_len - cross_t.x - up.x, qt.y - forward.y * train_len - cross_t.y - up.y, qt.z - forward.z * train_len - cross_t.z - up.z);
-			glEnd();
+			size_t instances = transforms[m]->size() / 16;
+			glBindVertexArray(this->train_meshes[m]->vao);
+			glBindBuffer(GL_ARRAY_BUFFER, this->train_meshes[m]->vbo[1]);
+			size_t first = 0;
+			for (size_t t = 0; t < tw->fleet.trains.size(); t++)
+			{
+				size_t cars = (size_t)tw->fleet.trains[t].carCount;
+				size_t count = (m == 0) ? 1 : (m == 1) ? cars - 1 : 4 * cars;
+				if (count == 0)
+					continue;
+				if (first + count > instances)
+					break;
+				for (int c = 0; c < 4; c++)
+					glVertexAttribPointer(2 + c, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(GLfloat),
+										  (GLvoid*)((first * 16 + c * 4) * sizeof(GLfloat)));
+				this->pick_train_shader->setUint(this->pick_train_object_id, makePickId(PICK_ID_TRAIN, (unsigned int)t));
+				glDrawArraysInstanced(GL_TRIANGLES, 0, this->train_meshes[m]->count, (GLsizei)count);
+				first += count;
+			}
 
+			// drawTrainMesh() draws all of them from the start of the buffer
+			for (int c = 0; c < 4; c++)
+				glVertexAttribPointer(2 + c, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(GLfloat), (GLvoid*)(c * 4 * sizeof(GLfloat)));
 		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindVertexArray(0);
+	}
 
-		glBegin(GL_TRIANGLE_FAN); //left front wheel  
-		glColor3f(255, 255, 255);
-		glVertex3f(qt.x + 0.5 * forward.x * train_len - 0.5 * cross_t.x - 1.2 * up.x, qt.y + 0.5 * forward.y * train_len - 0.5 * cross_t.y - 1.2 * up.y, qt.z + 0.5 * forward.z * train_len - 0.5 * cross_t.z - 1.2 * up.z);
-		int i = 0;
-		for (i = 0; i <= 360; i += 15)
-		{
-			float p = i * 3.14 / 180;
-			glColor3f(0, 0, 0);
-			glVertex3f(qt.x + 0.5 * forward.x * train_len - 0.5 * cross_t.x - 1.2 * up.x + sin(p) * -wheel_len * forward.x + up.x * cos(p) * wheel_len, qt.y + 0.5 * forward.y * train_len - 0.5 * cross_t.y - 1.2 * up.y + sin(p) * -wheel_len * forward.y + up.y * cos(p) * wheel_len, qt.z + 0.5 * forward.z * train_len - 0.5 * cross_t.z - 1.2 * up.z + sin(p) * -wheel_len * forward.z + up.z * cos(p) * wheel_len);
-		}
-		glEnd();
+	glUseProgram(0);
+	this->pick_buffer.end();
+	glViewport(0, 0, w(), h());
+}
 
-		glBegin(GL_TRIANGLE_FAN); //left back wheel  
-		glColor3f(255, 255, 255);
-		glVertex3f(qt.x - 0.5 * forward.x * train_len - 0.5 * cross_t.x - 1.2 * up.x, qt.y - 0.5 * forward.y * train_len - 0.5 * cross_t.y - 1.2 * up.y, qt.z - 0.5 * forward.z * train_len - 0.5 * cross_t.z - 1.2 * up.z);
-		for (i = 0; i <= 360; i += 15)
-		{
-			float p = i * 3.14 / 180;
-			glColor3f(0, 0, 0);
-			glVertex3f(qt.x - 0.5 * forward.x * train_len - 0.5 * cross_t.x - 1.2 * up.x + sin(p) * -wheel_len * forward.x + up.x * cos(p) * wheel_len, qt.y - 0.5 * forward.y * train_len - 0.5 * cross_t.y - 1.2 * up.y + sin(p) * -wheel_len * forward.y + up.y * cos(p) * wheel_len, qt.z - 0.5 * forward.z * train_len - 0.5 * cross_t.z - 1.2 * up.z + sin(p) * -wheel_len * forward.z + up.z * cos(p) * wheel_len);
-		}
-		glEnd();
+void TrainView::readPick()
+{
+	unsigned int id;
+	if (!this->pick_buffer.poll(id))
+	{
+		// not back yet - look again soon, even if nothing else is moving
+		Fl::add_timeout(0.01, pickWaitCB, this);
+		return;
+	}
 
-		glBegin(GL_TRIANGLE_FAN); //right back wheel  
-		glColor3f(255, 255, 255);
-		glVertex3f(qt.x - 0.5 * forward.x * train_len + 0.5 * cross_t.x - 1.2 * up.x, qt.y - 0.5 * forward.y * train_len + 0.5 * cross_t.y - 1.2 * up.y, qt.z - 0.5 * forward.z * train_len + 0.5 * cross_t.z - 1.2 * up.z);
-		for (i = 0; i <= 360; i += 15)
-		{
-			float p = i * 3.14 / 180;
-			glColor3f(0, 0, 0);
-			glVertex3f(qt.x - 0.5 * forward.x * train_len + 0.5 * cross_t.x - 1.2 * up.x + sin(p) * -wheel_len * forward.x + up.x * cos(p) * wheel_len, qt.y - 0.5 * forward.y * train_len + 0.5 * cross_t.y - 1.2 * up.y + sin(p) * -wheel_len * forward.y + up.y * cos(p) * wheel_len, qt.z - 0.5 * forward.z * train_len + 0.5 * cross_t.z - 1.2 * up.z + sin(p) * -wheel_len * forward.z + up.z * cos(p) * wheel_len);
-		}
-		glEnd();
-
-		glBegin(GL_TRIANGLE_FAN); //right front wheel  
-		glColor3f(255, 255, 255);
-		glVertex3f(qt.x + 0.5 * forward.x * train_len + 0.5 * cross_t.x - 1.2 * up.x, qt.y + 0.5 * forward.y * train_len + 0.5 * cross_t.y - 1.2 * up.y, qt.z + 0.5 * forward.z * train_len + 0.5 * cross_t.z - 1.2 * up.z);
-		for (i = 0; i <= 360; i += 15) {
-			float p = i * 3.14 / 180;
-			glColor3f(0, 0, 0);
-			glVertex3f(qt.x + 0.5 * forward.x * train_len + 0.5 * cross_t.x - 1.2 * up.x + sin(p) * -wheel_len * forward.x + up.x * cos(p) * wheel_len, qt.y + 0.5 * forward.y * train_len + 0.5 * cross_t.y - 1.2 * up.y + sin(p) * -wheel_len * forward.y + up.y * cos(p) * wheel_len, qt.z + 0.5 * forward.z * train_len + 0.5 * cross_t.z - 1.2 * up.z + sin(p) * -wheel_len * forward.z + up.z * cos(p) * wheel_len);
+	picked_object = id;
+	unsigned int index = pickIdIndex(id);
+	switch (pickIdKind(id)) {
+		case PICK_ID_CONTROL_POINT:
+			selectedCube = (int)index;
+			printf("Selected Cube %d\n", selectedCube);
+			break;
+		case PICK_ID_TRACK:
+			selectedSegment = (int)index;
+			printf("Selected track segment %d\n", selectedSegment);
+			break;
+		case PICK_ID_RIDE:
+			selectedRide = (int)index;
+			printf("Selected ride %s\n", RIDE_NAMES[index]);
+			break;
+		case PICK_ID_CUP:
+			printf("Selected the %s cup\n", CUP_NAMES[index]);
+			break;
+		case PICK_ID_FERRIS_CAR:
+			printf("Selected the %s car of the ferris wheel\n", FERRIS_CAR_NAMES[index]);
+			break;
+		case PICK_ID_TRAIN:
+			printf("Selected train %u\n", index);
+			break;
+		default:
+			printf("Selected Cube %d\n", selectedCube);
+			break;
+	}
+}
+
+void TrainView::buildParkBVH()
+{
+	// the index in RIDE_NAMES is the owner of the triangles
+	PlacedModel rides[RIDE_COUNT];
+	placeRides(this, rides);
+
+	this->park_bvh.clear();
+	for (int r = 0; r < RIDE_COUNT; r++) {
+		if (!rides[r].model)
+			continue;
+		for (size_t j = 0; j < rides[r].model->meshes.size(); j++) {
+			const Mesh& mesh = rides[r].model->meshes[j];
+			if (mesh.vertices.empty() || mesh.indices.empty())
+				continue;
+			this->park_bvh.addTriangles(&mesh.vertices[0].Position.x, sizeof(Vertex), &mesh.indices[0],
+										mesh.indices.size(), &rides[r].matrix[0][0], r);
 		}
-		glEnd();
-		preQt = qt - forward * train_len - 0.5 * up;
+	}
+	this->park_bvh.build();
+	this->clearance_version = m_pTrack->mesh.getVersion() - 1;
+}
+
+void TrainView::checkTrackClearance()
+{
+	if (this->clearance_version == m_pTrack->mesh.getVersion())
+		return;
+	this->clearance_version = m_pTrack->mesh.getVersion();
+
+	vector<ClearanceHit> hits;
+	checkClearance(this->park_bvh, m_pTrack->mesh.arcLength, trainEnvelope(1.0f), 1.0, 0, hits);
+
+	// only say something when the answer is different
+	bool same = hits.size() == this->clearance_hits.size();
+	for (size_t k = 0; same && k < hits.size(); k++)
+		same = fabs(hits[k].start - this->clearance_hits[k].start) < 0.5 &&
+			   fabs(hits[k].end - this->clearance_hits[k].end) < 0.5;
+	this->clearance_hits.swap(hits);
+	if (same)
+		return;
+
+	if (this->clearance_hits.empty())
+		cout << "track clearance: the train doesn't hit anything" << endl;
+	else {
+		cout << "track clearance: the train hits the rides in " << this->clearance_hits.size() << " places" << endl;
+		for (size_t k = 0; k < this->clearance_hits.size(); k++)
+			printf("  from %.1f to %.1f along the track\n", this->clearance_hits[k].start, this->clearance_hits[k].end);
 	}
 }
 
 void TrainView::drawSkybox()
 {
-	glm::mat4 view_matrix = glm::mat4();
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view_matrix[0][0]);
-	view_matrix = glm::inverse(view_matrix);
-	glm::vec3 pos = { view_matrix[3][0],view_matrix[3][1],view_matrix[3][2] };
+	glm::vec3 pos = this->camera.eye;
 	if (tw->stars->value()) {
 		this->renderSkyBox(*(this->skybox_shader), pos, this->skybox_stars_sky);
 	}
@@ -2021,51 +1861,6 @@ void TrainView::drawSkybox()
 	}
 }
 
-Pnt3f TrainView::GMT(const Pnt3f p0, const Pnt3f p1, const Pnt3f p2, const Pnt3f p3, const int type, const float t)
-{
-	glm::mat4x4 M;
-
-	if (type == 0 || type == 1) //default or linear
-	{
-		M = {
-			0,0,0,0,
-			0,0,-1,1,
-			0,0,1,0,
-			0,0,0,0
-		};
-	}
-	else if (type == 2) //cardinal
-	{
-		M = {
-			-1,2,-1,0,
-			3,-5,0,2,
-			-3,4,1,0,
-			1,-1,0,0
-		};
-		M /= 2;
-	}
-	else if (type == 3) //b-spline
-	{
-		M = {
-			-1,3,-3,1,
-			3,-6,0,4,
-			-3,3,3,1,
-			1,0,0,0
-		};
-		M /= 6.0f;
-	}
-	M = glm::transpose(M);
-	glm::mat4x4 G = {
-		p0.x, p0.y, p0.z, 1.0f,
-		p1.x, p1.y, p1.z, 1.0f,
-		p2.x, p2.y, p2.z, 1.0f,
-		p3.x, p3.y, p3.z, 1.0f
-	};
-	glm::vec4 T = { t * t * t,t * t,t,1.0f };
-	glm::vec4 outcome = G * M * T;
-	return Pnt3f(outcome[0], outcome[1], outcome[2]);
-}
-
 //--------------------------
 // 
 // Process skybox
@@ -2211,23 +2006,17 @@ void TrainView::loadSkyBox(GLuint& toBind, vector<string> paths) {
 void TrainView::renderSkyBox(Shader& s, glm::vec3 user_position, GLuint& toBind) {
 	glDepthMask(GL_FALSE);
 	s.Use();
-	// ... set view and projection matrix
-	glm::mat4 view_matrix = glm::mat4();
-	glm::mat4 project_matrix = glm::mat4();
+	// the view and projection come from the Frame block; the box is a
+	// big cube around the user
+	glm::mat4 model_matrix = glm::mat4();
 	//glEnable(GL_CULL_FACE);
-	glGetFloatv(GL_MODELVIEW_MATRIX, &view_matrix[0][0]);
-	glGetFloatv(GL_PROJECTION_MATRIX, &project_matrix[0][0]);
-	view_matrix = glm::translate(view_matrix, user_position);
-	view_matrix = glm::scale(view_matrix, glm::vec3(1000.0f, 1000.0f, 1000.0f));
+	model_matrix = glm::translate(model_matrix, user_position);
+	model_matrix = glm::scale(model_matrix, glm::vec3(1000.0f, 1000.0f, 1000.0f));
 
-	glUniformMatrix4fv(
-		glGetUniformLocation(s.Program, "view"), 1, GL_FALSE, &view_matrix[0][0]);
-	glUniformMatrix4fv(
-		glGetUniformLocation(s.Program, "projection"), 1, GL_FALSE, &project_matrix[0][0]);
+	s.setMat4(Shader::MODEL, &model_matrix[0][0]);
 
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_CUBE_MAP, toBind);
-	glUniform1i(glGetUniformLocation(s.Program, "skybox"), 0);
 
 	glBindVertexArray(this->skybox_points->vao);
 
@@ -117,7 +117,7 @@ TrainWindow(const int x, const int y)
 		// TODO: make sure these choices are the same as what the code supports
 		splineBrowser = new Fl_Browser(605,pty,120,75,"Spline Type");
 		splineBrowser->type(2);		// select
-		splineBrowser->callback((Fl_Callback*)damageCB,this);
+		splineBrowser->callback((Fl_Callback*)splineCB,this);
 		splineBrowser->add("Linear");
 		splineBrowser->add("Cardinal Cubic");
 		splineBrowser->add("Cubic B-Spline");
@@ -188,6 +188,24 @@ TrainWindow(const int x, const int y)
 		particleType->align(FL_ALIGN_LEFT);
 		particleType->type(FL_HORIZONTAL);
 
+		pty += 30;
+		carCount = new Fl_Value_Slider(655, pty, 140, 20, "Cars");
+		carCount->range(1, 64);
+		carCount->step(1);
+		carCount->value(8);
+		carCount->align(FL_ALIGN_LEFT);
+		carCount->type(FL_HORIZONTAL);
+		carCount->callback((Fl_Callback*)fleetCB, this);
+
+		pty += 30;
+		trainCount = new Fl_Value_Slider(655, pty, 140, 20, "Trains");
+		trainCount->range(1, 20);
+		trainCount->step(1);
+		trainCount->value(1);
+		trainCount->align(FL_ALIGN_LEFT);
+		trainCount->type(FL_HORIZONTAL);
+		trainCount->callback((Fl_Callback*)fleetCB, this);
+
 
 		// TODO: add widgets for all of your fancier features here
 #ifdef EXAMPLE_SOLUTION
@@ -233,6 +251,18 @@ damageMe()
 	trainView->damage(1);
 }
 
+//************************************************************************
+//
+// * The slider follows if trains had to be left off, or fit again
+//========================================================================
+void TrainWindow::
+trackChanged()
+//========================================================================
+{
+	m_Track.mesh.update(m_Track.points, splineBrowser->value());
+	trainCount->value(fleet.fit(m_Track.mesh.arcLength));
+}
+
 //************************************************************************
 //
 // * This will get called (approximately) 30 times per second
@@ -251,11 +281,29 @@ advanceTrain(float dir)
 	{
 		trainView->count_height_map -= 200;
 	}
-	trainView->trainU += (trainView->trainAcc + speed->value());
-	if (trainView->trainU >= trainView->totalArc)
+
+	// the speed slider is the chain lift, in units per 1/30 s like it
+	// always was. Going backwards it pulls the other way
+	const ArcLengthIndex& track = m_Track.mesh.arcLength;
+	fleet.liftSpeed = ((dir < 0) ? -1 : 1) * speed->value() * 30;
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	double dt;
+	if (dir == 1)
+	{
+		// run the time that really went by. A long gap means we were
+		// stopped, so count it as one tick
+		dt = std::chrono::duration<double>(now - lastAdvance).count();
+		if (dt > fleet.maxCatchUp)
+			dt = 1.0 / 30;
+	}
+	else
 	{
-		trainView->trainU -= trainView->totalArc;
+		// the step buttons run a fixed number of ticks
+		dt = fabs(dir) / 30;
 	}
+	fleet.advance(track, dt);
+	lastAdvance = now;
+	trainView->trainU = (float)fleet.trains[0].physics.position;
 
 #ifdef EXAMPLE_SOLUTION
 	// note - we give a little bit more example code here than normal,
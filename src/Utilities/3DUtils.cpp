@@ -234,7 +234,8 @@ void unsetupShadows(void)
 //   this code mimics page 147 of the OpenGL book
 //===============================================================================
 int getMouseLine(double& x1, double& y1, double& z1,
-								 double& x2, double& y2, double& z2)
+								 double& x2, double& y2, double& z2,
+								 double depth1, double depth2)
 //===============================================================================
 {
   int x = Fl::event_x();
@@ -249,8 +250,8 @@ int getMouseLine(double& x1, double& y1, double& z1,
 
   int y = viewport[3] - iy; // originally had an extra -1?
 
-  int i1 = gluUnProject((double) x, (double) y, .25, mat1, mat2, viewport, &x1, &y1, &z1);
-  int i2 = gluUnProject((double) x, (double) y, .75, mat1, mat2, viewport, &x2, &y2, &z2);
+  int i1 = gluUnProject((double) x, (double) y, depth1, mat1, mat2, viewport, &x1, &y1, &z1);
+  int i2 = gluUnProject((double) x, (double) y, depth2, mat1, mat2, viewport, &x2, &y2, &z2);
 
   return i1 && i2;
 }
@@ -103,8 +103,11 @@ void unsetupShadows(void);
 // Given the position of the mouse in 2D, we need to figure out where
 // it is in 3D. of course, its not in one place, its a line
 // this function gets that ray for you (well, it gets 2 points on the line)
+// the points are at depth1 and depth2 (0 is the near clipping
+// plane, 1 the far one)
 int getMouseLine(double& p1x, double& p1y, double& p1z,
-								 double& p2x, double& p2y, double& p2z);
+								 double& p2x, double& p2y, double& p2z,
+								 double depth1 = .25, double depth2 = .75);
 			  
 //************************************************************************
 //
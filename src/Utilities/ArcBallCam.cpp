@@ -119,21 +119,56 @@ void ArcBallCam::
 setProjection(bool doClear)
 //==========================================================================
 {
+  HMatrix m;
+
   glMatrixMode(GL_PROJECTION);
   if (doClear)
 	  glLoadIdentity();
-
-  // Compute the aspect ratio so we don't distort things
-  double aspect = ((double) wind->w()) / ((double) wind->h());
-  gluPerspective(fieldOfView, aspect, .1, 2000);
+  getProjectionMatrix(m);
+  glMultMatrixf((float*) m);
 
   // Put the camera where we want it to be
   glMatrixMode(GL_MODELVIEW);
-  glLoadIdentity();
+  getViewMatrix(m);
+  glLoadMatrixf((float*) m);
+}
+
+//**************************************************************************
+//
+// * What gluPerspective would make
+//==========================================================================
+void ArcBallCam::
+getProjectionMatrix(HMatrix m) const
+//==========================================================================
+{
+	// Compute the aspect ratio so we don't distort things
+	float aspect = ((float) wind->w()) / ((float) wind->h());
+	float zNear = .1f, zFar = 2000;
+	float f = 1.0f / (float) tan(fieldOfView * 3.14159265358979 / 360.0);
+
+	for (int c = 0; c < 4; c++)
+		for (int r = 0; r < 4; r++)
+			m[c][r] = 0;
+	m[0][0] = f / aspect;
+	m[1][1] = f;
+	m[2][2] = (zFar + zNear) / (zNear - zFar);
+	m[2][3] = -1;
+	m[3][2] = 2 * zFar * zNear / (zNear - zFar);
+}
 
-  // Use the transformation in the ArcBall
-  glTranslatef(-eyeX, -eyeY, -eyeZ);
-  multMatrix();
+//**************************************************************************
+//
+// * The turn of the ball, then moved away by the eye: what
+//   glTranslatef(-eye) and multMatrix() make
+//==========================================================================
+void ArcBallCam::
+getViewMatrix(HMatrix m) const
+//==========================================================================
+{
+	getMatrix(m);
+	m[3][0] -= eyeX;
+	m[3][1] -= eyeY;
+	m[3][2] -= eyeZ;
 }
 
 //**************************************************************************
@@ -8,8 +8,19 @@ out vec3 TexCoords;
 
 
 uniform mat4 model;
-uniform mat4 projection;
-uniform mat4 view;
+
+// the camera and the light, the same for every shader this frame (see
+// TrainView::setUBO)
+layout (std140) uniform Frame
+{
+    mat4 projection;
+    mat4 view;
+    vec4 eyePos;
+    vec4 lightDirection;
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
+};
 
 void main()
 {
@@ -17,5 +28,5 @@ void main()
     // Position = vec3(model * vec4(aPos, 1.0));
     // gl_Position = projection * view * vec4(Position, 1.0);
     TexCoords = aPos;
-    gl_Position = projection * view * vec4(aPos, 1.0);
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
 }  
\ No newline at end of file
@@ -12,14 +12,32 @@ out V_OUT
 
 
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// per object, one instance of it, out of the object buffer of the render
+// queue (see RenderQueue.H)
+layout (location = 3) in mat4 model;
+layout (location = 7) in mat3 normalMatrix;	// transpose(inverse(model))
+layout (location = 10) in vec2 lightStrength;	// diffuse, specular
+
+flat out vec2 strength;
+
+// the camera and the light, the same for every shader this frame (see
+// TrainView::setUBO)
+layout (std140) uniform Frame
+{
+    mat4 projection;
+    mat4 view;
+    vec4 eyePos;
+    vec4 lightDirection;
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
+};
 
 void main()
 {
  v_out.position = vec3(model * vec4(aPos, 1.0f));
-    v_out.normal = mat3(transpose(inverse(model))) * aNormal;
+    v_out.normal = normalMatrix * aNormal;
     v_out.texture_coordinate = aTexCoords;  
+    strength = lightStrength;
     gl_Position = projection * view * model * vec4(aPos, 1.0);
 }
\ No newline at end of file
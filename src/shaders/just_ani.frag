@@ -15,15 +15,30 @@
     vec3 specular;
 };
 
-	uniform vec3 viewPos;
-	uniform DirLight dirLight;
+	uniform float diffuseStrength;	// how much of the light this thing takes
+	uniform float specularStrength;
+
+	// the camera and the light, the same for every shader this frame (see
+	// TrainView::setUBO)
+	layout (std140) uniform Frame
+	{
+	    mat4 projection;
+	    mat4 view;
+	    vec4 eyePos;
+	    vec4 lightDirection;
+	    vec4 lightAmbient;
+	    vec4 lightDiffuse;
+	    vec4 lightSpecular;
+	};
 
 vec3 CalcDirLight(DirLight light,vec3 normal,vec3 viewDir);
 
 	void main()
 	{
 	vec3 norm = normalize(v_normal);
-    vec3 viewDir = normalize(viewPos - v_pos);
+    DirLight dirLight = DirLight(lightDirection.xyz, lightAmbient.xyz,
+                                 lightDiffuse.xyz * diffuseStrength, lightSpecular.xyz * specularStrength);
+    vec3 viewDir = normalize(eyePos.xyz - v_pos);
     vec3 color = vec3(texture(diff_texture,tex_cord));
     vec3 dirlight=CalcDirLight(dirLight, norm, viewDir);
  
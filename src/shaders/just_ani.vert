@@ -9,8 +9,22 @@
 	out vec3 v_pos;
 	out vec4 bw;
 	uniform mat4 bone_transforms[50];
-	uniform mat4 view_projection_matrix;
 	uniform mat4 model_matrix;
+	uniform mat3 normalMatrix;	// transpose(inverse(model_matrix)), made once per draw
+
+	// the camera and the light, the same for every shader this frame (see
+	// TrainView::setUBO)
+	layout (std140) uniform Frame
+	{
+	    mat4 projection;
+	    mat4 view;
+	    vec4 eyePos;
+	    vec4 lightDirection;
+	    vec4 lightAmbient;
+	    vec4 lightDiffuse;
+	    vec4 lightSpecular;
+	};
+
 	void main()
 	{
 		bw = vec4(0);
@@ -23,9 +37,10 @@
 		boneTransform  +=    bone_transforms[int(boneIds.z)] * boneWeights.z;
 		boneTransform  +=    bone_transforms[int(boneIds.w)] * boneWeights.w;
 		vec4 pos =boneTransform * vec4(position, 1.0);
-		gl_Position = view_projection_matrix * model_matrix * pos;
+		gl_Position = projection * view * model_matrix * pos;
 		v_pos = vec3(model_matrix * boneTransform * pos);
 		tex_cord = uv;
-		v_normal = mat3(transpose(inverse(model_matrix * boneTransform))) * normal;
+		// the bones only turn and move, so they turn the normals as they are
+		v_normal = normalMatrix * mat3(boneTransform) * normal;
 		v_normal = normalize(v_normal);
 	}
@@ -6,8 +6,19 @@ layout (location = 2) in vec2 aTexCoords;
 out vec2 TexCoords;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// the camera and the light, the same for every shader this frame (see
+// TrainView::setUBO)
+layout (std140) uniform Frame
+{
+    mat4 projection;
+    mat4 view;
+    vec4 eyePos;
+    vec4 lightDirection;
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
+};
 
 void main()
 {
@@ -0,0 +1,9 @@
+#version 330 core
+flat in uint id;
+
+out uint pickId;
+
+void main()
+{
+    pickId = id;
+}
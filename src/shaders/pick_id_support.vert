@@ -0,0 +1,31 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec4 instance;	// x, z, top, height
+
+uniform float halfWidth;
+uniform uint objectId;
+
+flat out uint id;
+
+// the camera and the light, the same for every shader this frame (see
+// TrainView::setUBO)
+layout (std140) uniform Frame
+{
+    mat4 projection;
+    mat4 view;
+    vec4 eyePos;
+    vec4 lightDirection;
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
+};
+
+void main()
+{
+    float width = (instance.w > 0.0) ? halfWidth : 0.0;
+    vec3 pos = vec3(instance.x + aPos.x * width,
+                    instance.z - (1.0 - aPos.y) * instance.w,
+                    instance.y + aPos.z * width);
+    gl_Position = projection * view * vec4(pos, 1.0);
+    id = objectId;
+}
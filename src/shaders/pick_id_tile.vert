@@ -0,0 +1,27 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in mat4 instance;
+
+uniform uint objectId;
+uniform uint idGroup;	// instances in a row that share an id
+
+flat out uint id;
+
+// the camera and the light, the same for every shader this frame (see
+// TrainView::setUBO)
+layout (std140) uniform Frame
+{
+    mat4 projection;
+    mat4 view;
+    vec4 eyePos;
+    vec4 lightDirection;
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
+};
+
+void main()
+{
+    gl_Position = projection * view * instance * vec4(aPos, 1.0);
+    id = objectId + uint(gl_InstanceID) / idGroup;
+}
@@ -0,0 +1,11 @@
+#version 330 core
+out vec4 FragColor;
+
+in float shade;
+
+uniform vec3 color;
+
+void main()
+{
+    FragColor = vec4(color * shade, 1.0);
+}
@@ -0,0 +1,31 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec4 instance;	// x, z, top, height
+
+uniform float halfWidth;
+
+out float shade;
+
+// the camera and the light, the same for every shader this frame (see
+// TrainView::setUBO)
+layout (std140) uniform Frame
+{
+    mat4 projection;
+    mat4 view;
+    vec4 eyePos;
+    vec4 lightDirection;
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
+};
+
+void main()
+{
+    // a pillar of height 0 collapses to a point and draws nothing
+    float width = (instance.w > 0.0) ? halfWidth : 0.0;
+    vec3 pos = vec3(instance.x + aPos.x * width,
+                    instance.z - (1.0 - aPos.y) * instance.w,
+                    instance.y + aPos.z * width);
+    shade = 0.6 + 0.4 * aPos.y;
+    gl_Position = projection * view * vec4(pos, 1.0);
+}
@@ -17,8 +17,20 @@ vec2 texture_coordinate;
 
 uniform sampler2D u_texture;
 uniform sampler2D u_heightMap;
-uniform vec3 viewPos;
-uniform DirLight dirLight;
+flat in vec2 strength;	// how much of the light this thing takes: diffuse, specular
+
+// the camera and the light, the same for every shader this frame (see
+// TrainView::setUBO)
+layout (std140) uniform Frame
+{
+    mat4 projection;
+    mat4 view;
+    vec4 eyePos;
+    vec4 lightDirection;
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
+};
 
 vec3 CalcDirLight(DirLight light,vec3 normal,vec3 viewDir);
 
@@ -34,7 +46,9 @@ void main()
     vec3 dv=vec3(0.0,dy,dz);
     vec3 norm = normalize(cross(dv,du));
 
-    vec3 viewDir = normalize(viewPos - f_in.position);
+    DirLight dirLight = DirLight(lightDirection.xyz, lightAmbient.xyz,
+                                 lightDiffuse.xyz * strength.x, lightSpecular.xyz * strength.y);
+    vec3 viewDir = normalize(eyePos.xyz - f_in.position);
     vec3 color = vec3(texture(u_texture,f_in.texture_coordinate));
     vec3 dirlight=CalcDirLight(dirLight, norm, viewDir);
  